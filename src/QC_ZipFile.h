@@ -35,7 +35,22 @@ DLLLOCAL extern qore_classid_t CID_ZIPFILE;
 // Initialize the ZipFile class
 DLLLOCAL QoreClass* initZipFileClass(QoreNamespace& ns);
 
+// Class for ZipEntry
+DLLLOCAL extern QoreClass* QC_ZIPENTRY;
+
 // Initialize the ZipEntry class
 DLLLOCAL QoreClass* initZipEntryClass(QoreNamespace& ns);
 
+// Class for ZipEntryIterator
+DLLLOCAL extern QoreClass* QC_ZIPENTRYITERATOR;
+
+// Initialize the ZipEntryIterator class
+DLLLOCAL QoreClass* initZipEntryIteratorClass(QoreNamespace& ns);
+
+// Class for ZipJob
+DLLLOCAL extern QoreClass* QC_ZIPJOB;
+
+// Initialize the ZipJob class
+DLLLOCAL QoreClass* initZipJobClass(QoreNamespace& ns);
+
 #endif // _QORE_ZIP_QC_ZIPFILE_H
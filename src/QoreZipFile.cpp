@@ -27,32 +27,69 @@
 #include "QoreZipFile.h"
 #include "ZipInputStream.h"
 #include "ZipOutputStream.h"
+#include "ZipEntryIterator.h"
+#include "ZipIndexCache.h"
+#include "ZipExtractor.h"
+#include "ZipVerifier.h"
+#include "ZipTreeWalker.h"
 
+#include <mz_crypt.h>
+
+#include <algorithm>
+#include <climits>
 #include <cstring>
 #include <ctime>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <fnmatch.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 // Forward declarations for class IDs
 DLLLOCAL extern qore_classid_t CID_ZIPINPUTSTREAM;
 DLLLOCAL extern qore_classid_t CID_ZIPOUTPUTSTREAM;
 DLLLOCAL extern QoreClass* QC_ZIPINPUTSTREAM;
 DLLLOCAL extern QoreClass* QC_ZIPOUTPUTSTREAM;
+DLLLOCAL extern QoreClass* QC_ZIPENTRYITERATOR;
+DLLLOCAL extern QoreClass* QC_ZIPJOB;
+
+// Checks sandbox access to an index file without raising an exception; index files are optional
+static bool check_index_access(const std::string& path, int access) {
+    QoreSandboxManager* sm = runtime_get_sandbox_manager();
+    if (!sm) {
+        return true;
+    }
+    ExceptionSink xsink;
+    if (!sm->checkFilesystemAccess(path.c_str(), access, &xsink)) {
+        xsink.clear();
+        return false;
+    }
+    return true;
+}
 
 // Constructor for file-based archive
-QoreZipFile::QoreZipFile(const char* path, ZipMode m, ExceptionSink* xsink)
-    : filepath(path), mode(m), reader(nullptr), writer(nullptr), mem_stream(nullptr),
-      in_memory(false), closed(false), active_streams(0), max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
+QoreZipFile::QoreZipFile(const char* path, ZipMode m, const QoreHashNode* opts, ExceptionSink* xsink)
+    : filepath(path), mode(m), writer(nullptr), mem_stream(nullptr),
+      in_memory(false), closed(false), active_streams(0),
+      max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
     if (mode == ZIP_MODE_READ) {
-        openRead(xsink);
+        openRead(opts, xsink);
+        // The index and reader pool are immutable from now on, so read operations need no lock
+        if (index) {
+            read_gate.open();
+        }
     } else {
-        openWrite(xsink);
+        openWrite(opts, xsink);
     }
 }
 
 // Constructor for in-memory archive (from binary data)
 QoreZipFile::QoreZipFile(const BinaryNode* data, ExceptionSink* xsink)
-    : mode(ZIP_MODE_READ), reader(nullptr), writer(nullptr), mem_stream(nullptr),
-      in_memory(true), closed(false), active_streams(0), max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
+    : mode(ZIP_MODE_READ), writer(nullptr), mem_stream(nullptr),
+      in_memory(true), closed(false), active_streams(0),
+      max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
     // Create memory stream from binary data
     mem_stream = mz_stream_mem_create();
     if (!mem_stream) {
@@ -60,29 +97,20 @@ QoreZipFile::QoreZipFile(const BinaryNode* data, ExceptionSink* xsink)
         return;
     }
 
-    // Open using buffer API
-    reader = mz_zip_reader_create();
-    if (!reader) {
-        mz_stream_mem_delete(&mem_stream);
-        mem_stream = nullptr;
-        xsink->raiseException("ZIP-ERROR", "failed to create zip reader");
-        return;
-    }
+    // Reader handles are opened on the buffer without copying it; the pool holds a reference to the data
+    readers.setBuffer(data);
 
-    int32_t err = mz_zip_reader_open_buffer(reader, (const uint8_t*)data->getPtr(), data->size(), 0);
-    if (err != MZ_OK) {
-        mz_zip_reader_delete(&reader);
-        reader = nullptr;
-        mz_stream_mem_delete(&mem_stream);
-        mem_stream = nullptr;
-        xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive from binary data: error %d", err);
+    ZipMemoryArchiveData archive_data(data->getPtr(), data->size());
+    if (buildIndex(&archive_data, xsink)) {
+        read_gate.open();
     }
 }
 
 // Constructor for new in-memory archive
 QoreZipFile::QoreZipFile(ExceptionSink* xsink)
-    : mode(ZIP_MODE_WRITE), reader(nullptr), writer(nullptr), mem_stream(nullptr),
-      in_memory(true), closed(false), active_streams(0), max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
+    : mode(ZIP_MODE_WRITE), writer(nullptr), mem_stream(nullptr),
+      in_memory(true), closed(false), active_streams(0),
+      max_alloc_size(ZIP_DEFAULT_MAX_ALLOC_SIZE) {
     // Create memory stream for writing
     mem_stream = mz_stream_mem_create();
     if (!mem_stream) {
@@ -125,29 +153,127 @@ QoreZipFile::~QoreZipFile() {
     close(&xsink);
 }
 
-void QoreZipFile::openRead(ExceptionSink* xsink) {
+void QoreZipFile::openRead(const QoreHashNode* opts, ExceptionSink* xsink) {
     // Check filesystem sandbox access
     QoreSandboxManager* sm = runtime_get_sandbox_manager();
     if (sm && !sm->checkFilesystemAccess(filepath.c_str(), QSEC_READ, xsink)) {
         return;
     }
 
-    reader = mz_zip_reader_create();
-    if (!reader) {
-        xsink->raiseException("ZIP-ERROR", "failed to create zip reader");
+    std::string index_path;
+    bool use_mmap = false;
+    if (opts) {
+        use_mmap = opts->getKeyValue("mmap").getAsBool();
+        QoreValue v = opts->getKeyValue("index_path");
+        if (!v.isNothing() && v.getType() == NT_STRING) {
+            index_path = v.get<const QoreStringNode>()->c_str();
+        } else if (opts->getKeyValue("persistent_index").getAsBool()) {
+            index_path = filepath + ".idx";
+        }
+    }
+
+    // The archive file is opened only once: the index keys and all reader handles are based on this file
+    // descriptor, so the index always describes the data read even if the file is replaced after it was opened
+    int fd = open(filepath.c_str(), O_RDONLY);
+    ZipIndexCacheKey cache_key;
+    if (fd < 0 || cache_key.read(fd)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive '%s' for reading: error %d",
+                              filepath.c_str(), MZ_OPEN_ERROR);
         return;
     }
+    readers.setFile(filepath, fd, (int64)cache_key.size, use_mmap);
+
+    // Indexes are shared by all objects in the process that open the same version of an archive file
+    index = zip_index_cache.get(cache_key);
+
+    ZipIndexKey key;
+    if (!index_path.empty() && (key.read(fd) || !check_index_access(index_path, QSEC_READ))) {
+        index_path.clear();
+    }
+
+    if (!index && !index_path.empty()) {
+        std::shared_ptr<ZipEntryIndex> file_index(new ZipEntryIndex);
+        if (file_index->load(index_path.c_str(), key)) {
+            index = file_index;
+            zip_index_cache.put(cache_key, index);
+        }
+    }
+
+    bool built = false;
+    if (!index) {
+        // A memory-mapped archive is indexed from the mapping
+        std::unique_ptr<ZipArchiveData> archive_data;
+        const char* mapped;
+        int64 mapped_size;
+        int32_t err;
+        if (!readers.getMapping(mapped, mapped_size, err)) {
+            archive_data.reset(new ZipMemoryArchiveData(mapped, (size_t)mapped_size));
+        } else {
+            archive_data.reset(new ZipFileArchiveData(fd, (int64)cache_key.size));
+        }
+        if (!buildIndex(archive_data.get(), xsink)) {
+            return;
+        }
+        built = true;
+        zip_index_cache.put(cache_key, index);
+    }
+
+    // Failing to write the index file is not an error, the archive is just indexed again the next time; if the
+    // index was not built here, the file is only written if it does not exist yet
+    if (!index_path.empty() && (built || access(index_path.c_str(), F_OK))
+        && check_index_access(index_path, QSEC_WRITE | QSEC_CREATE)) {
+        index->save(index_path.c_str(), key);
+    }
+}
+
+bool QoreZipFile::buildIndex(const ZipArchiveData* data, ExceptionSink* xsink) {
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
+        return false;
+    }
 
-    int32_t err = mz_zip_reader_open_file(reader, filepath.c_str());
+    std::shared_ptr<ZipEntryIndex> new_index(new ZipEntryIndex);
+    int32_t err = new_index->build(holder.getZipHandle(), data);
     if (err != MZ_OK) {
-        mz_zip_reader_delete(&reader);
-        reader = nullptr;
-        xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive '%s' for reading: error %d",
-                              filepath.c_str(), err);
+        xsink->raiseException("ZIP-ERROR", "failed to index ZIP archive entries: error %d", err);
+        return false;
+    }
+
+    index = new_index;
+    return true;
+}
+
+mz_zip_file* QoreZipFile::locateEntryUnlocked(void* zip_handle, const char* name, ExceptionSink* xsink) {
+    int64 i = index->find(name);
+    if (i < 0) {
+        xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+        return nullptr;
+    }
+
+    mz_zip_file* file_info = gotoEntry(zip_handle, index->getCdPos(i));
+    if (!file_info) {
+        xsink->raiseException("ZIP-ERROR", "failed to get entry info for '%s'", name);
+        return nullptr;
     }
+
+    return file_info;
+}
+
+mz_zip_file* QoreZipFile::gotoEntry(void* zip_handle, int64 cd_pos) {
+    // Seek directly to the entry's central directory record
+    mz_zip_file* file_info = nullptr;
+    if (mz_zip_goto_entry(zip_handle, cd_pos) != MZ_OK
+        || mz_zip_entry_get_info(zip_handle, &file_info) != MZ_OK) {
+        return nullptr;
+    }
+
+    return file_info;
 }
 
-void QoreZipFile::openWrite(ExceptionSink* xsink) {
+void QoreZipFile::openWrite(const QoreHashNode* opts, ExceptionSink* xsink) {
     // Check filesystem sandbox access (need write and create for new files)
     QoreSandboxManager* sm = runtime_get_sandbox_manager();
     if (sm && !sm->checkFilesystemAccess(filepath.c_str(), QSEC_WRITE | QSEC_CREATE, xsink)) {
@@ -167,7 +293,30 @@ void QoreZipFile::openWrite(ExceptionSink* xsink) {
         writer = nullptr;
         xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive '%s' for writing: error %d",
                               filepath.c_str(), err);
+        return;
     }
+
+    // Entries are only compressed in parallel if the threads option is given, even with one thread, so that the
+    // archive is the same for any number of threads
+    if (opts && !opts->getKeyValue("threads").isNothing()) {
+        int64 threads = getThreadCount(opts, xsink);
+        if (threads < 0) {
+            return;
+        }
+        parallel_writer.reset(new ZipParallelWriter(writer, (unsigned)threads));
+    }
+}
+
+int QoreZipFile::flushUnlocked(ExceptionSink* xsink) {
+    if (!parallel_writer) {
+        return 0;
+    }
+    QoreString error;
+    if (parallel_writer->flush(error)) {
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+        return -1;
+    }
+    return 0;
 }
 
 void QoreZipFile::close(ExceptionSink* xsink) {
@@ -177,18 +326,35 @@ void QoreZipFile::close(ExceptionSink* xsink) {
         return;
     }
 
+    // Wait for read operations in progress; streams and jobs are only started in the read gate, so their counts
+    // cannot grow once it is closed
+    bool readable = read_gate.isOpen();
+    read_gate.close();
+
     // Check for active streams
     if (active_streams > 0) {
+        if (readable) {
+            read_gate.open();
+        }
         xsink->raiseException("ZIP-ERROR", "cannot close archive with %d active stream(s)", (int)active_streams);
         return;
     }
 
-    if (reader) {
-        mz_zip_reader_close(reader);
-        mz_zip_reader_delete(&reader);
-        reader = nullptr;
+    // Wait for asynchronous jobs
+    {
+        std::unique_lock<std::mutex> job_guard(job_lock);
+        while (active_jobs) {
+            job_cond.wait(job_guard);
+        }
     }
 
+    readers.clear();
+    index.reset();
+
+    // Entries that cannot be written are reported after the archive has been closed
+    flushUnlocked(xsink);
+    parallel_writer.reset();
+
     if (writer) {
         mz_zip_writer_close(writer);
         mz_zip_writer_delete(&writer);
@@ -223,6 +389,11 @@ BinaryNode* QoreZipFile::toData(ExceptionSink* xsink) {
         return nullptr;
     }
 
+    if (flushUnlocked(xsink)) {
+        return nullptr;
+    }
+    parallel_writer.reset();
+
     if (writer) {
         // Close the writer first to finalize the archive
         mz_zip_writer_close(writer);
@@ -280,7 +451,8 @@ bool QoreZipFile::checkOpenUnlocked(ExceptionSink* xsink, bool forWrite) {
         return false;
     }
 
-    if (!forWrite && !reader) {
+    // The index is set when the archive has been opened for reading
+    if (!forWrite && !index) {
         xsink->raiseException("ZIP-ERROR", "archive is not open for reading");
         return false;
     }
@@ -288,6 +460,20 @@ bool QoreZipFile::checkOpenUnlocked(ExceptionSink* xsink, bool forWrite) {
     return true;
 }
 
+bool QoreZipFile::checkReadable(const ZipReadGuard& guard, ExceptionSink* xsink) const {
+    if (guard) {
+        return true;
+    }
+
+    // The gate of an archive opened for reading is only closed by close(), which sets the closed flag last
+    if (closed || mode == ZIP_MODE_READ) {
+        xsink->raiseException("ZIP-ERROR", "archive is closed");
+    } else {
+        xsink->raiseException("ZIP-ERROR", "archive is not open for reading");
+    }
+    return false;
+}
+
 bool QoreZipFile::validateExtractPath(const char* entry_name, const char* dest_path, ExceptionSink* xsink) {
     // Check for path traversal attempts
     if (!entry_name) {
@@ -325,159 +511,492 @@ bool QoreZipFile::validateExtractPath(const char* entry_name, const char* dest_p
     return true;
 }
 
-QoreHashNode* QoreZipFile::createEntryInfo(mz_zip_file* file_info, ExceptionSink* xsink) {
+QoreHashNode* QoreZipFile::createEntryInfo(const char* name, int64 size, int64 compressed_size, int64 modified,
+                                          int64 crc, int compression_method, bool is_encrypted, const char* comment,
+                                          size_t comment_len, ExceptionSink* xsink) {
     ReferenceHolder<QoreHashNode> h(new QoreHashNode(hashdeclZipEntryInfo, xsink), xsink);
 
-    h->setKeyValue("name", new QoreStringNode(file_info->filename), xsink);
-    h->setKeyValue("size", file_info->uncompressed_size, xsink);
-    h->setKeyValue("compressed_size", file_info->compressed_size, xsink);
+    h->setKeyValue("name", new QoreStringNode(name), xsink);
+    h->setKeyValue("size", size, xsink);
+    h->setKeyValue("compressed_size", compressed_size, xsink);
 
     // Convert time_t to date
     DateTimeNode* dt = DateTimeNode::makeAbsolute(
         currentTZ(),
-        (int64)file_info->modified_date,
+        modified,
         0
     );
     h->setKeyValue("modified", dt, xsink);
 
-    h->setKeyValue("crc32", (int64)file_info->crc, xsink);
-    h->setKeyValue("compression_method", (int64)file_info->compression_method, xsink);
+    h->setKeyValue("crc32", crc, xsink);
+    h->setKeyValue("compression_method", (int64)compression_method, xsink);
 
     // Check if directory (filename ends with /)
-    size_t len = strlen(file_info->filename);
-    bool is_dir = (len > 0 && file_info->filename[len - 1] == '/');
+    size_t len = strlen(name);
+    bool is_dir = (len > 0 && name[len - 1] == '/');
     h->setKeyValue("is_directory", is_dir, xsink);
-    h->setKeyValue("is_encrypted", (bool)(file_info->flag & MZ_ZIP_FLAG_ENCRYPTED), xsink);
+    h->setKeyValue("is_encrypted", is_encrypted, xsink);
 
-    if (file_info->comment && file_info->comment_size > 0) {
-        h->setKeyValue("comment", new QoreStringNode(file_info->comment, file_info->comment_size, QCS_UTF8), xsink);
+    if (comment_len > 0) {
+        h->setKeyValue("comment", new QoreStringNode(comment, comment_len, QCS_UTF8), xsink);
     }
 
     return h.release();
 }
 
+QoreHashNode* QoreZipFile::createEntryInfo(size_t i, ExceptionSink* xsink) {
+    const char* comment = nullptr;
+    size_t comment_len = 0;
+    index->getComment(i, comment, comment_len);
+
+    return createEntryInfo(index->getName(i), index->getSize(i), index->getCompressedSize(i),
+                           index->getModified(i), (int64)index->getCrc(i), index->getMethod(i),
+                           index->isEncrypted(i), comment, comment_len, xsink);
+}
+
 QoreListNode* QoreZipFile::entries(ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    ReferenceHolder<QoreListNode> list(new QoreListNode(hashdeclZipEntryInfo->getTypeInfo(true)), xsink);
+
+    for (size_t i = 0, e = index->getEntryCount(); i < e; ++i) {
+        list->push(createEntryInfo(i, xsink), xsink);
+    }
+
+    return list.release();
+}
+
+QoreHashNode* QoreZipFile::entriesColumnar(ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    ReferenceHolder<QoreListNode> names(new QoreListNode(stringTypeInfo), xsink);
+    ReferenceHolder<QoreListNode> sizes(new QoreListNode(bigIntTypeInfo), xsink);
+    ReferenceHolder<QoreListNode> compressed_sizes(new QoreListNode(bigIntTypeInfo), xsink);
+    ReferenceHolder<QoreListNode> crcs(new QoreListNode(bigIntTypeInfo), xsink);
+    ReferenceHolder<QoreListNode> modified(new QoreListNode(dateTypeInfo), xsink);
+    ReferenceHolder<QoreListNode> methods(new QoreListNode(bigIntTypeInfo), xsink);
+
+    const AbstractQoreZoneInfo* tz = currentTZ();
+    for (size_t i = 0, e = index->getEntryCount(); i < e; ++i) {
+        names->push(new QoreStringNode(index->getName(i)), xsink);
+        sizes->push(index->getSize(i), xsink);
+        compressed_sizes->push(index->getCompressedSize(i), xsink);
+        crcs->push((int64)index->getCrc(i), xsink);
+        modified->push(DateTimeNode::makeAbsolute(tz, index->getModified(i), 0), xsink);
+        methods->push((int64)index->getMethod(i), xsink);
+    }
+
+    ReferenceHolder<QoreHashNode> h(new QoreHashNode(hashdeclZipEntryColumns, xsink), xsink);
+    h->setKeyValue("name", names.release(), xsink);
+    h->setKeyValue("size", sizes.release(), xsink);
+    h->setKeyValue("compressed_size", compressed_sizes.release(), xsink);
+    h->setKeyValue("crc32", crcs.release(), xsink);
+    h->setKeyValue("modified", modified.release(), xsink);
+    h->setKeyValue("compression_method", methods.release(), xsink);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    return h.release();
+}
+
+QoreListNode* QoreZipFile::list(const char* pattern, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
         return nullptr;
     }
 
+    // Only the literal part of a glob pattern before the first special character narrows the index range
+    size_t literal_len = strcspn(pattern, "*?[\\");
+    bool is_glob = pattern[literal_len] != '\0';
+    std::string prefix(pattern, literal_len);
+
     ReferenceHolder<QoreListNode> list(new QoreListNode(hashdeclZipEntryInfo->getTypeInfo(true)), xsink);
 
-    int32_t err = mz_zip_reader_goto_first_entry(reader);
-    while (err == MZ_OK) {
-        mz_zip_file* file_info = nullptr;
-        err = mz_zip_reader_entry_get_info(reader, &file_info);
-        if (err != MZ_OK) {
+    for (size_t i = index->lowerBound(prefix.c_str()), e = index->size(); i < e; ++i) {
+        const char* name = index->getSortedName(i);
+        if (strncmp(name, prefix.c_str(), prefix.size())) {
             break;
         }
-
-        list->push(createEntryInfo(file_info, xsink), xsink);
-        err = mz_zip_reader_goto_next_entry(reader);
+        if (is_glob && fnmatch(pattern, name, 0)) {
+            continue;
+        }
+        list->push(createEntryInfo(index->getSortedIndex(i), xsink), xsink);
     }
 
-    if (err != MZ_END_OF_LIST && err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "error reading archive entries: %d", err);
+    return list.release();
+}
+
+QoreListNode* QoreZipFile::listDirectory(const char* prefix, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
         return nullptr;
     }
 
+    std::string dir(prefix);
+    if (!dir.empty() && dir.back() != '/') {
+        dir += '/';
+    }
+
+    ReferenceHolder<QoreListNode> list(new QoreListNode(hashdeclZipEntryInfo->getTypeInfo(true)), xsink);
+
+    size_t i = index->lowerBound(dir.c_str());
+    while (i < index->size()) {
+        const char* name = index->getSortedName(i);
+        if (strncmp(name, dir.c_str(), dir.size())) {
+            break;
+        }
+
+        const char* slash = strchr(name + dir.size(), '/');
+        if (!slash) {
+            // File directly in the directory
+            list->push(createEntryInfo(index->getSortedIndex(i), xsink), xsink);
+            ++i;
+            continue;
+        }
+
+        if (slash == name + dir.size()) {
+            // The directory entry itself or an entry with an empty path component
+            ++i;
+            continue;
+        }
+
+        // Subdirectory: an explicit directory entry always sorts before its contents; directories that
+        // only exist implicitly as the parent path of other entries are reported with a synthetic entry
+        std::string subdir(name, slash + 1 - name);
+        if (!slash[1]) {
+            list->push(createEntryInfo(index->getSortedIndex(i), xsink), xsink);
+        } else {
+            list->push(createEntryInfo(subdir.c_str(), 0, 0, 0, 0, 0, false, nullptr, 0, xsink), xsink);
+        }
+
+        // Skip the rest of the subdirectory; '0' is the character following '/'
+        subdir.back() = '0';
+        i = index->lowerBound(subdir.c_str());
+    }
+
     return list.release();
 }
 
+QoreZipEntry* QoreZipFile::createEntry(size_t i) const {
+    const char* name = index->getName(i);
+    size_t len = strlen(name);
+    bool is_dir = (len > 0 && name[len - 1] == '/');
+
+    std::string comment;
+    const char* comment_ptr;
+    size_t comment_len;
+    if (index->getComment(i, comment_ptr, comment_len)) {
+        comment.assign(comment_ptr, comment_len);
+    }
+
+    return new QoreZipEntry(std::string(name, len), index->getSize(i), index->getCompressedSize(i),
+                            index->getModified(i), (int64)index->getCrc(i), index->getMethod(i), is_dir,
+                            index->isEncrypted(i), comment);
+}
+
+QoreZipEntry* QoreZipFile::nextEntry(int64& pos, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    if (pos + 1 >= index->getEntryCount()) {
+        return nullptr;
+    }
+
+    return createEntry(++pos);
+}
+
+QoreObject* QoreZipFile::iterator(ExceptionSink* xsink) {
+    {
+        ZipReadGuard guard(read_gate);
+
+        if (!checkReadable(guard, xsink)) {
+            return nullptr;
+        }
+    }
+
+    return new QoreObject(QC_ZIPENTRYITERATOR, getProgram(), new QoreZipEntryIterator(this));
+}
+
 int64 QoreZipFile::count(ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return -1;
     }
 
-    int64 count = 0;
-    int32_t err = mz_zip_reader_goto_first_entry(reader);
-    while (err == MZ_OK) {
-        count++;
-        err = mz_zip_reader_goto_next_entry(reader);
+    return index->getEntryCount();
+}
+
+QoreHashNode* QoreZipFile::summary(ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
     }
 
-    return count;
+    ReferenceHolder<QoreHashNode> h(new QoreHashNode(hashdeclZipArchiveSummary, xsink), xsink);
+    h->setKeyValue("count", index->getEntryCount(), xsink);
+    h->setKeyValue("size", index->getTotalSize(), xsink);
+    h->setKeyValue("compressed_size", index->getTotalCompressedSize(), xsink);
+    h->setKeyValue("directories", index->getDirectoryCount(), xsink);
+    h->setKeyValue("encrypted", index->getEncryptedCount(), xsink);
+
+    // Per-method counts keyed by the compression method number
+    ZipEntryIndex::method_count_map_t method_counts;
+    index->getMethodCounts(method_counts);
+    ReferenceHolder<QoreHashNode> methods(new QoreHashNode(bigIntTypeInfo), xsink);
+    for (auto& i : method_counts) {
+        QoreString key;
+        key.sprintf("%d", i.first);
+        methods->setKeyValue(key.c_str(), i.second, xsink);
+    }
+    h->setKeyValue("methods", methods.release(), xsink);
+
+    return h.release();
 }
 
 bool QoreZipFile::hasEntry(const char* name, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return false;
     }
 
-    int32_t err = mz_zip_reader_locate_entry(reader, name, 0);
-    return err == MZ_OK;
+    return index->find(name) >= 0;
 }
 
 BinaryNode* QoreZipFile::read(const char* name, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return nullptr;
     }
 
-    int32_t err = mz_zip_reader_locate_entry(reader, name, 0);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+    // Stored entries of memory-mapped archives are copied directly from the mapping
+    if (readers.isMapped()) {
+        int64 i = index->find(name);
+        BinaryNode* data;
+        if (i >= 0 && readMappedUnlocked(i, name, data, xsink)) {
+            return data;
+        }
+    }
+
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
         return nullptr;
     }
 
-    mz_zip_file* file_info = nullptr;
-    err = mz_zip_reader_entry_get_info(reader, &file_info);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "failed to get entry info for '%s'", name);
+    void* zip_handle = holder.getZipHandle();
+    mz_zip_file* file_info = locateEntryUnlocked(zip_handle, name, xsink);
+    if (!file_info) {
+        return nullptr;
+    }
+
+    return readEntryUnlocked(zip_handle, name, file_info, xsink);
+}
+
+QoreHashNode* QoreZipFile::readMany(const QoreListNode* names, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    // Resolve all entries first, so that the data can be read in the order it is stored in the archive
+    struct entry_request {
+        int64 local_offset;
+        int64 cd_pos;
+        size_t pos;
+        int64 entry;
+    };
+    std::vector<entry_request> requests;
+    requests.reserve(names->size());
+    for (size_t i = 0, e = names->size(); i < e; ++i) {
+        const char* name = names->retrieveEntry(i).get<const QoreStringNode>()->c_str();
+        int64 entry = index->find(name);
+        if (entry < 0) {
+            xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+            return nullptr;
+        }
+        requests.push_back({index->getLocalOffset(entry), index->getCdPos(entry), i, entry});
+    }
+
+    std::stable_sort(requests.begin(), requests.end(), [] (const entry_request& a, const entry_request& b) {
+        return a.local_offset < b.local_offset;
+    });
+
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
+        return nullptr;
+    }
+    void* zip_handle = holder.getZipHandle();
+
+    std::vector<BinaryNode*> data(requests.size(), nullptr);
+    for (const entry_request& r : requests) {
+        const char* name = names->retrieveEntry(r.pos).get<const QoreStringNode>()->c_str();
+        // Stored entries of memory-mapped archives are copied directly from the mapping
+        if (!readers.isMapped() || !readMappedUnlocked(r.entry, name, data[r.pos], xsink)) {
+            mz_zip_file* file_info = gotoEntry(zip_handle, r.cd_pos);
+            if (!file_info) {
+                xsink->raiseException("ZIP-ERROR", "failed to get entry info for '%s'", name);
+            } else {
+                data[r.pos] = readEntryUnlocked(zip_handle, name, file_info, xsink);
+            }
+        }
+        if (*xsink) {
+            for (BinaryNode* b : data) {
+                if (b) {
+                    b->deref();
+                }
+            }
+            return nullptr;
+        }
+    }
+
+    // Keys are added in the requested order
+    ReferenceHolder<QoreHashNode> h(new QoreHashNode(binaryTypeInfo), xsink);
+    for (size_t i = 0, e = data.size(); i < e; ++i) {
+        h->setKeyValue(names->retrieveEntry(i).get<const QoreStringNode>()->c_str(), data[i], xsink);
+    }
+
+    return h.release();
+}
+
+bool QoreZipFile::readMappedUnlocked(int64 i, const char* name, BinaryNode*& data, ExceptionSink* xsink) {
+    data = nullptr;
+    const char* mapped;
+    int64 mapped_size;
+    int32_t err;
+    if (index->getMethod(i) != MZ_COMPRESS_METHOD_STORE || index->isEncrypted(i)
+        || index->getSize(i) != index->getCompressedSize(i) || readers.getMapping(mapped, mapped_size, err)) {
+        return false;
+    }
+
+    // Entries with an invalid local header are left to minizip to report the error
+    int64 size = index->getSize(i);
+    ZipMemoryArchiveData archive_data(mapped, (size_t)mapped_size);
+    int64 offset = index->getDataOffset(archive_data, i);
+    if (offset < 0 || size > mapped_size - offset) {
+        return false;
+    }
+
+    if (size > max_alloc_size) {
+        xsink->raiseException("ZIP-ERROR", "entry '%s' size %lld exceeds maximum allocation size %lld", name,
+                              (long long)size, (long long)max_alloc_size);
+        return true;
+    }
+    if (!size) {
+        data = new BinaryNode();
+        return true;
+    }
+
+    char* buf = (char*)malloc(size);
+    if (!buf) {
+        xsink->raiseException("ZIP-ERROR", "failed to allocate memory for entry '%s'", name);
+        return true;
+    }
+    memcpy(buf, mapped + offset, size);
+
+    // The data is verified like data read by minizip
+    uint32_t crc = 0;
+    for (int64 done = 0; done < size; ) {
+        int32_t n = (int32_t)std::min(size - done, (int64)INT_MAX);
+        crc = mz_crypt_crc32_update(crc, (const uint8_t*)buf + done, n);
+        done += n;
+    }
+    if (crc != index->getCrc(i)) {
+        free(buf);
+        xsink->raiseException("ZIP-ERROR", "failed to read entry '%s': error %d", name, MZ_CRC_ERROR);
+        return true;
+    }
+
+    data = new BinaryNode(buf, size);
+    return true;
+}
+
+BinaryNode* QoreZipFile::readEntryUnlocked(void* zip_handle, const char* name, mz_zip_file* file_info,
+                                           ExceptionSink* xsink) {
+    char* buf;
+    int64 len;
+    QoreString error;
+    if (readEntryData(zip_handle, name, file_info, password.empty() ? nullptr : password.c_str(), max_alloc_size,
+                      buf, len, error)) {
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
         return nullptr;
     }
 
+    return buf ? new BinaryNode(buf, len) : new BinaryNode();
+}
+
+int QoreZipFile::readEntryData(void* zip_handle, const char* name, const mz_zip_file* file_info,
+                               const char* entry_password, int64 max_alloc_size, char*& buf, int64& len,
+                               QoreString& error) {
+    buf = nullptr;
+    len = 0;
+
     // Handle empty files
     if (file_info->uncompressed_size == 0) {
-        return new BinaryNode();
+        return 0;
     }
 
     // Check allocation size limit
     if ((int64)file_info->uncompressed_size > max_alloc_size) {
-        xsink->raiseException("ZIP-ERROR", "entry '%s' size %lld exceeds maximum allocation size %lld",
-                              name, (long long)file_info->uncompressed_size, (long long)max_alloc_size);
-        return nullptr;
-    }
-
-    if (!password.empty()) {
-        mz_zip_reader_set_password(reader, password.c_str());
+        error.sprintf("entry '%s' size %lld exceeds maximum allocation size %lld", name,
+                      (long long)file_info->uncompressed_size, (long long)max_alloc_size);
+        return -1;
     }
 
-    err = mz_zip_reader_entry_open(reader);
+    int32_t err = mz_zip_entry_read_open(zip_handle, 0, entry_password);
     if (err != MZ_OK) {
         // Provide more specific error for wrong password
         if (file_info->flag & MZ_ZIP_FLAG_ENCRYPTED) {
-            xsink->raiseException("ZIP-ERROR", "failed to open encrypted entry '%s' for reading: error %d (wrong password?)", name, err);
+            error.sprintf("failed to open encrypted entry '%s' for reading: error %d (wrong password?)", name, err);
         } else {
-            xsink->raiseException("ZIP-ERROR", "failed to open entry '%s' for reading: error %d", name, err);
+            error.sprintf("failed to open entry '%s' for reading: error %d", name, err);
         }
-        return nullptr;
+        return -1;
     }
 
     // Allocate buffer
-    void* buf = malloc(file_info->uncompressed_size);
+    int64 size = file_info->uncompressed_size;
+    buf = (char*)malloc(size);
     if (!buf) {
-        mz_zip_reader_entry_close(reader);
-        xsink->raiseException("ZIP-ERROR", "failed to allocate memory for entry '%s'", name);
-        return nullptr;
+        mz_zip_entry_close(zip_handle);
+        error.sprintf("failed to allocate memory for entry '%s'", name);
+        return -1;
     }
 
-    int32_t bytes_read = mz_zip_reader_entry_read(reader, buf, file_info->uncompressed_size);
-    mz_zip_reader_entry_close(reader);
-
-    if (bytes_read < 0) {
-        free(buf);
-        xsink->raiseException("ZIP-ERROR", "failed to read entry '%s': error %d", name, bytes_read);
-        return nullptr;
+    while (len < size) {
+        int64 remaining = size - len;
+        int32_t bytes_read = mz_zip_entry_read(zip_handle, buf + len,
+            remaining > INT_MAX ? INT_MAX : (int32_t)remaining);
+        if (bytes_read < 0) {
+            mz_zip_entry_close(zip_handle);
+            free(buf);
+            buf = nullptr;
+            len = 0;
+            error.sprintf("failed to read entry '%s': error %d", name, bytes_read);
+            return -1;
+        }
+        if (!bytes_read) {
+            break;
+        }
+        len += bytes_read;
     }
+    mz_zip_entry_close(zip_handle);
 
-    return new BinaryNode(buf, bytes_read);
+    return 0;
 }
 
 QoreStringNode* QoreZipFile::readText(const char* name, const char* encoding, ExceptionSink* xsink) {
@@ -491,26 +1010,19 @@ QoreStringNode* QoreZipFile::readText(const char* name, const char* encoding, Ex
 }
 
 QoreHashNode* QoreZipFile::getEntry(const char* name, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return nullptr;
     }
 
-    int32_t err = mz_zip_reader_locate_entry(reader, name, 0);
-    if (err != MZ_OK) {
+    int64 i = index->find(name);
+    if (i < 0) {
         xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
         return nullptr;
     }
 
-    mz_zip_file* file_info = nullptr;
-    err = mz_zip_reader_entry_get_info(reader, &file_info);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "failed to get entry info for '%s'", name);
-        return nullptr;
-    }
-
-    return createEntryInfo(file_info, xsink);
+    return createEntryInfo(i, xsink);
 }
 
 void QoreZipFile::parseAddOptions(const QoreHashNode* opts, int16_t& compression_method, int16_t& compression_level,
@@ -551,20 +1063,112 @@ void QoreZipFile::parseAddOptions(const QoreHashNode* opts, int16_t& compression
 }
 
 void QoreZipFile::add(const char* name, const BinaryNode* data, const QoreHashNode* opts, ExceptionSink* xsink) {
-    QoreAutoRWWriteLocker lock(rwlock);
+    std::unique_ptr<ZipWriteEntry> entry(compressEntry(name, data, nullptr, opts, xsink));
+    if (*xsink) {
+        return;
+    }
+
+    QoreAutoRWWriteLocker lock(rwlock);
 
     if (!checkOpenUnlocked(xsink, true)) {
         return;
     }
 
+    if (entry) {
+        writeEntryUnlocked(*entry, xsink);
+        return;
+    }
+
     addUnlocked(name, data, opts, xsink);
 }
 
+ZipWriteEntry* QoreZipFile::compressEntry(const char* name, const BinaryNode* data, const char* filepath,
+                                          const QoreHashNode* opts, ExceptionSink* xsink) {
+    {
+        QoreAutoRWReadLocker lock(rwlock);
+        if (!checkOpenUnlocked(xsink, true)) {
+            return nullptr;
+        }
+        // In parallel mode, entries are queued under the write lock to keep them in the order they were added
+        if (parallel_writer) {
+            return nullptr;
+        }
+    }
+
+    int16_t compression_method, compression_level;
+    std::string entry_password, comment;
+    int64 modified_time;
+    parseAddOptions(opts, compression_method, compression_level, entry_password, comment, modified_time, xsink);
+    int64 entry_threads = getEntryThreadCount(opts, xsink);
+    if (entry_threads < 0 || !ZipParallelWriter::canCompress(compression_method, !entry_password.empty())) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+    entry->name = name;
+    entry->compression_method = compression_method;
+    entry->compression_level = compression_level;
+    entry->threads = (unsigned)entry_threads;
+    entry->long_window = getLongWindow(opts, compression_method);
+    if (data) {
+        entry->comment = comment;
+        entry->modified = modified_time ? modified_time : time(nullptr);
+        data->ref();
+        entry->data = data;
+    } else {
+        // As with mz_zip_writer_add_file(), the entry gets the modification time and attributes of the file
+        entry->path = filepath;
+    }
+
+    ZipParallelWriter::compress(*entry);
+    if (entry->err != MZ_OK) {
+        QoreString error;
+        ZipParallelWriter::getError(*entry, entry->err, error);
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+        return nullptr;
+    }
+    return entry.release();
+}
+
+void QoreZipFile::writeEntryUnlocked(ZipWriteEntry& entry, ExceptionSink* xsink) {
+    int32_t err = ZipParallelWriter::write(writer, entry);
+    if (err != MZ_OK) {
+        QoreString error;
+        ZipParallelWriter::getError(entry, err, error);
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+    }
+}
+
 void QoreZipFile::addUnlocked(const char* name, const BinaryNode* data, const QoreHashNode* opts, ExceptionSink* xsink) {
     int16_t compression_method, compression_level;
     std::string entry_password, comment;
     int64 modified_time;
     parseAddOptions(opts, compression_method, compression_level, entry_password, comment, modified_time, xsink);
+    int64 entry_threads = getEntryThreadCount(opts, xsink);
+    if (entry_threads < 0) {
+        return;
+    }
+    bool long_window = getLongWindow(opts, compression_method);
+
+    if (parallel_writer && ZipParallelWriter::canCompress(compression_method, !entry_password.empty())) {
+        std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+        entry->name = name;
+        entry->comment = comment;
+        entry->modified = modified_time ? modified_time : time(nullptr);
+        entry->compression_method = compression_method;
+        entry->compression_level = compression_level;
+        entry->threads = (unsigned)entry_threads;
+        entry->long_window = long_window;
+        data->ref();
+        entry->data = data;
+        addEntryUnlocked(entry.release(), xsink);
+        return;
+    }
+
+    // Other entries are added directly after all queued entries
+    if (flushUnlocked(xsink)) {
+        return;
+    }
 
     mz_zip_file file_info;
     memset(&file_info, 0, sizeof(file_info));
@@ -592,6 +1196,13 @@ void QoreZipFile::addUnlocked(const char* name, const BinaryNode* data, const Qo
     }
 }
 
+void QoreZipFile::addEntryUnlocked(ZipWriteEntry* entry, ExceptionSink* xsink) {
+    QoreString error;
+    if (parallel_writer->add(entry, error)) {
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+    }
+}
+
 void QoreZipFile::addText(const char* name, const QoreStringNode* text, const char* encoding,
                            const QoreHashNode* opts, ExceptionSink* xsink) {
     // Convert to specified encoding if necessary (can be done without lock)
@@ -603,25 +1214,29 @@ void QoreZipFile::addText(const char* name, const QoreStringNode* text, const ch
     SimpleRefHolder<BinaryNode> bin(new BinaryNode());
     bin->append(teh->c_str(), teh->size());
 
-    QoreAutoRWWriteLocker lock(rwlock);
+    add(name, *bin, opts, xsink);
+}
 
-    if (!checkOpenUnlocked(xsink, true)) {
+void QoreZipFile::addFile(const char* name, const char* filepath, const QoreHashNode* opts, ExceptionSink* xsink) {
+    // Check filesystem sandbox access before reading source file
+    QoreSandboxManager* sm = runtime_get_sandbox_manager();
+    if (sm && !sm->checkFilesystemAccess(filepath, QSEC_READ, xsink)) {
         return;
     }
 
-    addUnlocked(name, *bin, opts, xsink);
-}
+    std::unique_ptr<ZipWriteEntry> entry(compressEntry(name, nullptr, filepath, opts, xsink));
+    if (*xsink) {
+        return;
+    }
 
-void QoreZipFile::addFile(const char* name, const char* filepath, const QoreHashNode* opts, ExceptionSink* xsink) {
     QoreAutoRWWriteLocker lock(rwlock);
 
     if (!checkOpenUnlocked(xsink, true)) {
         return;
     }
 
-    // Check filesystem sandbox access before reading source file
-    QoreSandboxManager* sm = runtime_get_sandbox_manager();
-    if (sm && !sm->checkFilesystemAccess(filepath, QSEC_READ, xsink)) {
+    if (entry) {
+        writeEntryUnlocked(*entry, xsink);
         return;
     }
 
@@ -629,6 +1244,29 @@ void QoreZipFile::addFile(const char* name, const char* filepath, const QoreHash
     std::string entry_password, comment;
     int64 modified_time;
     parseAddOptions(opts, compression_method, compression_level, entry_password, comment, modified_time, xsink);
+    int64 entry_threads = getEntryThreadCount(opts, xsink);
+    if (entry_threads < 0) {
+        return;
+    }
+    bool long_window = getLongWindow(opts, compression_method);
+
+    if (parallel_writer && ZipParallelWriter::canCompress(compression_method, !entry_password.empty())) {
+        // The file is read by the thread compressing it; as with mz_zip_writer_add_file(), the entry gets the
+        // modification time and attributes of the file
+        std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+        entry->name = name;
+        entry->compression_method = compression_method;
+        entry->compression_level = compression_level;
+        entry->threads = (unsigned)entry_threads;
+        entry->long_window = long_window;
+        entry->path = filepath;
+        addEntryUnlocked(entry.release(), xsink);
+        return;
+    }
+
+    if (flushUnlocked(xsink)) {
+        return;
+    }
 
     if (!entry_password.empty()) {
         mz_zip_writer_set_password(writer, entry_password.c_str());
@@ -645,6 +1283,234 @@ void QoreZipFile::addFile(const char* name, const char* filepath, const QoreHash
     }
 }
 
+int QoreZipFile::parseBatchOptions(const QoreHashNode* opts, int16_t& compression_method, int16_t& compression_level,
+                                   int64& threads, ExceptionSink* xsink) {
+    std::string entry_password, comment;
+    int64 modified_time;
+    parseAddOptions(opts, compression_method, compression_level, entry_password, comment, modified_time, xsink);
+    if (!ZipParallelWriter::canCompress(compression_method, false)) {
+        xsink->raiseException("ZIP-ERROR", "compression method %d is not supported when adding files in a batch",
+                              (int)compression_method);
+        return -1;
+    }
+
+    // Batches are read and compressed with one thread per CPU core by default
+    threads = getEntryThreadCount(opts, xsink);
+    if (threads < 0) {
+        return -1;
+    }
+    if (!threads) {
+        threads = std::min((int64)std::max(std::thread::hardware_concurrency(), 1u), (int64)ZIP_MAX_THREADS);
+    }
+    return 0;
+}
+
+void QoreZipFile::addTree(const char* dir, const QoreHashNode* opts, ExceptionSink* xsink) {
+    {
+        QoreAutoRWReadLocker lock(rwlock);
+        if (!checkOpenUnlocked(xsink, true)) {
+            return;
+        }
+    }
+
+    int16_t compression_method, compression_level;
+    int64 threads;
+    if (parseBatchOptions(opts, compression_method, compression_level, threads, xsink)) {
+        return;
+    }
+
+    std::string prefix;
+    bool directories = true;
+    if (opts) {
+        QoreValue v = opts->getKeyValue("prefix");
+        if (!v.isNothing() && v.getType() == NT_STRING) {
+            prefix = v.get<const QoreStringNode>()->c_str();
+            if (!prefix.empty() && prefix.back() != '/') {
+                prefix += '/';
+            }
+        }
+        v = opts->getKeyValue("directories");
+        if (!v.isNothing()) {
+            directories = v.getAsBool();
+        }
+    }
+
+    // The tree is listed without holding the archive lock; each directory is checked against the filesystem
+    // sandbox before it is listed, which also covers the files read from it
+    QoreSandboxManager* sm = runtime_get_sandbox_manager();
+    ZipTreeWalker walker(dir, (unsigned)threads);
+    std::vector<ZipTreeEntry> tree;
+    std::string error;
+    if (walker.walk([sm, xsink] (const std::string& path) -> int {
+            return (sm && !sm->checkFilesystemAccess(path.c_str(), QSEC_READ, xsink)) ? -1 : 0;
+        }, tree, error)) {
+        if (!*xsink) {
+            xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+        }
+        return;
+    }
+
+    ZipWriteEntryList entries;
+    entries.reserve(tree.size());
+    for (ZipTreeEntry& te : tree) {
+        if (te.is_dir && !directories) {
+            continue;
+        }
+        std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+        entry->name = prefix + te.name;
+        entry->path = std::move(te.path);
+        if (te.is_dir) {
+            entry->directory = true;
+            entry->compression_method = MZ_COMPRESS_METHOD_STORE;
+        } else {
+            entry->compression_method = compression_method;
+            entry->compression_level = compression_level;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    addBatch(entries, (unsigned)threads, xsink);
+}
+
+void QoreZipFile::addFiles(const QoreListNode* specs, const QoreHashNode* opts, ExceptionSink* xsink) {
+    {
+        QoreAutoRWReadLocker lock(rwlock);
+        if (!checkOpenUnlocked(xsink, true)) {
+            return;
+        }
+    }
+
+    int16_t compression_method, compression_level;
+    int64 threads;
+    if (parseBatchOptions(opts, compression_method, compression_level, threads, xsink)) {
+        return;
+    }
+
+    // Source files are checked against the filesystem sandbox once per directory
+    QoreSandboxManager* sm = runtime_get_sandbox_manager();
+    std::unordered_set<std::string> checked_dirs;
+
+    ZipWriteEntryList entries;
+    entries.reserve(specs->size());
+    for (size_t i = 0, e = specs->size(); i < e; ++i) {
+        const QoreHashNode* spec = specs->retrieveEntry(i).get<const QoreHashNode>();
+        std::string path = spec->getKeyValue("path").get<const QoreStringNode>()->c_str();
+        if (path.empty()) {
+            xsink->raiseException("ZIP-ERROR", "file specification %d has an empty path", (int)i);
+            return;
+        }
+
+        std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+        size_t slash = path.rfind('/');
+        QoreValue v = spec->getKeyValue("name");
+        if (!v.isNothing() && v.getType() == NT_STRING) {
+            entry->name = v.get<const QoreStringNode>()->c_str();
+        } else {
+            entry->name = slash == std::string::npos ? path : path.substr(slash + 1);
+        }
+        if (entry->name.empty()) {
+            xsink->raiseException("ZIP-ERROR", "file specification %d has no entry name for path '%s'",
+                                  (int)i, path.c_str());
+            return;
+        }
+
+        if (sm) {
+            std::string dir = slash == std::string::npos ? std::string(".") : path.substr(0, slash ? slash : 1);
+            if (checked_dirs.insert(dir).second && !sm->checkFilesystemAccess(dir.c_str(), QSEC_READ, xsink)) {
+                return;
+            }
+        }
+
+        // Options given in the specification override the options for the batch
+        entry->compression_method = compression_method;
+        entry->compression_level = compression_level;
+        v = spec->getKeyValue("compression_method");
+        if (!v.isNothing()) {
+            entry->compression_method = (int16_t)v.getAsBigInt();
+            if (!ZipParallelWriter::canCompress(entry->compression_method, false)) {
+                xsink->raiseException("ZIP-ERROR", "compression method %d of file specification %d is not "
+                                      "supported when adding files in a batch", (int)entry->compression_method,
+                                      (int)i);
+                return;
+            }
+        }
+        v = spec->getKeyValue("compression_level");
+        if (!v.isNothing()) {
+            entry->compression_level = (int16_t)v.getAsBigInt();
+        }
+        v = spec->getKeyValue("modified");
+        if (!v.isNothing() && v.getType() == NT_DATE) {
+            entry->modified = v.get<const DateTimeNode>()->getEpochSecondsUTC();
+        }
+        v = spec->getKeyValue("comment");
+        if (!v.isNothing() && v.getType() == NT_STRING) {
+            entry->comment = v.get<const QoreStringNode>()->c_str();
+        }
+
+        entry->path = std::move(path);
+        entries.push_back(std::move(entry));
+    }
+
+    addBatch(entries, (unsigned)threads, xsink);
+}
+
+void QoreZipFile::addBatch(ZipWriteEntryList& entries, unsigned threads, ExceptionSink* xsink) {
+    QoreAutoRWWriteLocker lock(rwlock);
+
+    if (!checkOpenUnlocked(xsink, true)) {
+        return;
+    }
+
+    // Entries are compressed in parallel and written in order; in parallel mode they are queued with the entries
+    // already added, otherwise a writer is used for this batch only
+    std::unique_ptr<ZipParallelWriter> batch_writer;
+    ZipParallelWriter* pw = parallel_writer.get();
+    if (!pw) {
+        batch_writer.reset(new ZipParallelWriter(writer, threads));
+        pw = batch_writer.get();
+    }
+
+    QoreString error;
+    int rc = 0;
+    for (std::unique_ptr<ZipWriteEntry>& entry : entries) {
+        if (pw->add(entry.release(), error)) {
+            rc = -1;
+            break;
+        }
+    }
+    if (!rc && batch_writer) {
+        rc = batch_writer->flush(error);
+    }
+    if (rc) {
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+    }
+}
+
+void QoreZipFile::commitStreamEntry(ZipWriteEntry& entry, void* entry_reader, ExceptionSink* xsink) {
+    QoreAutoRWWriteLocker lock(rwlock);
+
+    if (!checkOpenUnlocked(xsink, true)) {
+        return;
+    }
+
+    // Entries queued in parallel mode are written first
+    if (flushUnlocked(xsink)) {
+        return;
+    }
+
+    if (!entry_reader) {
+        writeEntryUnlocked(entry, xsink);
+        return;
+    }
+
+    // The entry was compressed and encrypted by minizip while the stream was written; it is copied as a raw entry
+    mz_zip_writer_set_password(writer, nullptr);
+    int32_t err = mz_zip_writer_copy_from_reader(writer, entry_reader);
+    if (err != MZ_OK) {
+        xsink->raiseException("ZIP-ERROR", "failed to add entry '%s': error %d", entry.name.c_str(), err);
+    }
+}
+
 void QoreZipFile::addDirectory(const char* name, ExceptionSink* xsink) {
     QoreAutoRWWriteLocker lock(rwlock);
 
@@ -652,6 +1518,10 @@ void QoreZipFile::addDirectory(const char* name, ExceptionSink* xsink) {
         return;
     }
 
+    if (flushUnlocked(xsink)) {
+        return;
+    }
+
     // Ensure name ends with /
     std::string dir_name = name;
     if (dir_name.empty() || dir_name.back() != '/') {
@@ -680,49 +1550,302 @@ void QoreZipFile::addDirectory(const char* name, ExceptionSink* xsink) {
     }
 }
 
+int64 QoreZipFile::getThreadCount(const QoreHashNode* opts, ExceptionSink* xsink) const {
+    int64 threads = parseThreadCount(opts, xsink);
+    if (threads > 1 && index) {
+        threads = std::max(std::min(threads, index->getEntryCount()), (int64)1);
+    }
+    return threads;
+}
+
+int64 QoreZipFile::getEntryThreadCount(const QoreHashNode* opts, ExceptionSink* xsink) {
+    if (!opts || opts->getKeyValue("threads").isNothing()) {
+        return 0;
+    }
+    return parseThreadCount(opts, xsink);
+}
+
+bool QoreZipFile::getLongWindow(const QoreHashNode* opts, int16_t compression_method) {
+    return opts && compression_method == MZ_COMPRESS_METHOD_ZSTD && opts->getKeyValue("long_window").getAsBool();
+}
+
+int64 QoreZipFile::parseThreadCount(const QoreHashNode* opts, ExceptionSink* xsink) {
+    int64 threads = 1;
+    if (opts) {
+        QoreValue v = opts->getKeyValue("threads");
+        if (!v.isNothing()) {
+            threads = v.getAsBigInt();
+        }
+    }
+    if (threads < 0) {
+        xsink->raiseException("ZIP-ERROR", "invalid thread count %lld; expecting 0 or a positive number",
+                              (long long)threads);
+        return -1;
+    }
+    if (!threads) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return std::min(threads, (int64)ZIP_MAX_THREADS);
+}
+
 void QoreZipFile::extractAll(const char* destPath, const QoreHashNode* opts, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return;
+    }
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    ZipExtractPlan plan;
+    if (prepareExtractUnlocked(destPath, opts, plan, xsink)) {
         return;
     }
 
+    QoreString error;
+    if (ZipExtractor::extractAll(readers, plan, error)) {
+        xsink->raiseException("ZIP-ERROR", "%s", error.c_str());
+    }
+}
+
+int QoreZipFile::prepareExtractUnlocked(const char* destPath, const QoreHashNode* opts, ZipExtractPlan& plan,
+                                        ExceptionSink* xsink) {
     // Check filesystem sandbox access before writing to destination
     QoreSandboxManager* sm = runtime_get_sandbox_manager();
     if (sm && !sm->checkFilesystemAccess(destPath, QSEC_WRITE | QSEC_CREATE, xsink)) {
-        return;
+        return -1;
     }
 
-    // First, validate all entry paths for security
-    int32_t err = mz_zip_reader_goto_first_entry(reader);
-    while (err == MZ_OK) {
-        mz_zip_file* file_info = nullptr;
-        err = mz_zip_reader_entry_get_info(reader, &file_info);
-        if (err == MZ_OK && file_info) {
-            if (!validateExtractPath(file_info->filename, destPath, xsink)) {
-                return;
-            }
+    int64 queue_depth = 0;
+    if (opts) {
+        QoreValue v = opts->getKeyValue("password");
+        if (!v.isNothing() && v.getType() == NT_STRING) {
+            plan.password = v.get<const QoreStringNode>()->c_str();
+            plan.has_password = true;
+        }
+        v = opts->getKeyValue("queue_depth");
+        if (!v.isNothing()) {
+            queue_depth = v.getAsBigInt();
+        }
+    }
+    int64 threads = getThreadCount(opts, xsink);
+    if (threads < 0) {
+        return -1;
+    }
+    if (queue_depth < 0) {
+        xsink->raiseException("ZIP-ERROR", "invalid queue depth %lld; expecting 0 or a positive number",
+                              (long long)queue_depth);
+        return -1;
+    }
+    plan.threads = (unsigned)threads;
+    plan.queue_depth = (size_t)queue_depth;
+
+    // Validate all entry paths and collect the entries to extract in one pass over the in-memory index, so that
+    // nothing is written if any entry fails validation; for duplicate names, only the last entry is extracted, as
+    // it would overwrite the others anyway
+    std::string dest_dir(destPath);
+    if (dest_dir.empty() || dest_dir.back() != '/') {
+        dest_dir += '/';
+    }
+    size_t count = index->getEntryCount();
+    std::unordered_set<std::string> seen;
+    bool has_duplicates = count > index->size();
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (size_t i = count; i-- > 0; ) {
+        const char* name = index->getName(i);
+        if (!validateExtractPath(name, destPath, xsink)) {
+            return -1;
+        }
+        if (!has_duplicates || seen.insert(name).second) {
+            order.push_back((uint32_t)i);
         }
-        err = mz_zip_reader_goto_next_entry(reader);
+    }
+    // Entries are extracted in central directory order by a single thread, which is normally also the order of
+    // the data, and largest first by several threads, so that no single large entry is left for the end
+    std::reverse(order.begin(), order.end());
+    if (threads > 1) {
+        const ZipEntryIndex* ix = index.get();
+        std::stable_sort(order.begin(), order.end(), [ix] (uint32_t a, uint32_t b) {
+            return ix->getSize(a) > ix->getSize(b);
+        });
+    }
+
+    plan.tasks.reserve(order.size());
+    for (uint32_t i : order) {
+        plan.tasks.push_back({index->getCdPos(i), dest_dir + index->getName(i)});
+    }
+    return 0;
+}
+
+QoreObject* QoreZipFile::readAsync(const char* name, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
     }
 
+    int64 i = index->find(name);
+    if (i < 0) {
+        xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+        return nullptr;
+    }
+
+    ZipReaderPool* pool = &readers;
+    int64 cd_pos = index->getCdPos(i);
+    std::string entry_name(name);
+    std::string entry_password(password);
+    int64 max_alloc = max_alloc_size;
+    return startJobUnlocked([pool, cd_pos, entry_name, entry_password, max_alloc] (ZipJobResult& result) -> int {
+        int32_t err = MZ_OK;
+        void* reader = pool->acquire(err);
+        if (!reader) {
+            result.error.sprintf("failed to open ZIP archive for reading: error %d", err);
+            return -1;
+        }
+
+        int rc = 0;
+        mz_zip_file* file_info = gotoEntry(ZipReaderPool::getZipHandle(reader), cd_pos);
+        if (!file_info) {
+            result.error.sprintf("failed to get entry info for '%s'", entry_name.c_str());
+            rc = -1;
+        } else {
+            rc = readEntryData(ZipReaderPool::getZipHandle(reader), entry_name.c_str(), file_info,
+                               entry_password.empty() ? nullptr : entry_password.c_str(), max_alloc, result.data,
+                               result.size, result.error);
+            result.has_data = true;
+        }
+        pool->release(reader);
+        return rc;
+    }, xsink);
+}
+
+QoreObject* QoreZipFile::extractAllAsync(const char* destPath, const QoreHashNode* opts, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    // Entry paths are validated before the job is started
+    std::shared_ptr<ZipExtractPlan> plan(new ZipExtractPlan);
+    if (prepareExtractUnlocked(destPath, opts, *plan, xsink)) {
+        return nullptr;
+    }
+
+    ZipReaderPool* pool = &readers;
+    return startJobUnlocked([pool, plan] (ZipJobResult& result) -> int {
+        return ZipExtractor::extractAll(*pool, *plan, result.error);
+    }, xsink);
+}
+
+QoreObject* QoreZipFile::startJobUnlocked(const zip_job_func_t& func, ExceptionSink* xsink) {
+    refJob();
+    ReferenceHolder<QoreZipJob> job(new QoreZipJob(this, func), xsink);
+    if (job->start(xsink)) {
+        return nullptr;
+    }
+    return new QoreObject(QC_ZIPJOB, getProgram(), job.release());
+}
+
+void QoreZipFile::refJob() {
+    std::lock_guard<std::mutex> lock(job_lock);
+    ++active_jobs;
+}
+
+void QoreZipFile::derefJob() {
+    std::lock_guard<std::mutex> lock(job_lock);
+    if (!--active_jobs) {
+        job_cond.notify_all();
+    }
+}
+
+QoreHashNode* QoreZipFile::verify(const QoreHashNode* opts, ExceptionSink* xsink) {
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
+
+    const char* verify_password = password.empty() ? nullptr : password.c_str();
+    bool errors_only = false;
     if (opts) {
         QoreValue v = opts->getKeyValue("password");
         if (!v.isNothing() && v.getType() == NT_STRING) {
-            mz_zip_reader_set_password(reader, v.get<const QoreStringNode>()->c_str());
+            verify_password = v.get<const QoreStringNode>()->c_str();
         }
+        errors_only = opts->getKeyValue("errors_only").getAsBool();
+    }
+    int64 threads = getThreadCount(opts, xsink);
+    if (threads < 0) {
+        return nullptr;
     }
 
-    err = mz_zip_reader_save_all(reader, destPath);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "failed to extract archive to '%s': error %d", destPath, err);
+    ZipVerifier verifier(readers, *index, verify_password);
+    verifier.run((unsigned)threads);
+
+    size_t count = index->getEntryCount();
+    int64 errors = 0;
+    int64 total_size = 0;
+    ReferenceHolder<QoreListNode> entries(new QoreListNode(hashdeclZipEntryVerifyResult->getTypeInfo()), xsink);
+    for (size_t i = 0; i < count; ++i) {
+        const ZipVerifyResult& result = verifier.getResult(i);
+        if (result.status == ZipVerifyResult::NOT_CHECKED) {
+            xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive for verification: error %d",
+                                  verifier.getOpenError());
+            return nullptr;
+        }
+        total_size += result.size;
+        bool ok = result.status == ZipVerifyResult::OK;
+        if (!ok) {
+            ++errors;
+        } else if (errors_only) {
+            continue;
+        }
+
+        ReferenceHolder<QoreHashNode> h(new QoreHashNode(hashdeclZipEntryVerifyResult, xsink), xsink);
+        h->setKeyValue("name", new QoreStringNode(index->getName(i)), xsink);
+        h->setKeyValue("ok", ok, xsink);
+        h->setKeyValue("size", result.size, xsink);
+        h->setKeyValue("crc32", (int64)result.crc, xsink);
+        if (!ok) {
+            QoreStringNode* error = new QoreStringNode;
+            switch (result.status) {
+                case ZipVerifyResult::OPEN_ERROR:
+                    if (index->isEncrypted(i)) {
+                        error->sprintf("failed to open encrypted entry: error %d (wrong or missing password?)",
+                                       result.error_code);
+                    } else {
+                        error->sprintf("failed to open entry: error %d", result.error_code);
+                    }
+                    break;
+                case ZipVerifyResult::READ_ERROR:
+                    error->sprintf("failed to read entry data: error %d", result.error_code);
+                    break;
+                case ZipVerifyResult::CRC_MISMATCH:
+                    error->sprintf("CRC-32 mismatch: expected %08x, got %08x", index->getCrc(i), result.crc);
+                    break;
+                default:
+                    error->sprintf("size mismatch: expected %lld bytes, got %lld", (long long)index->getSize(i),
+                                   (long long)result.size);
+                    break;
+            }
+            h->setKeyValue("error", error, xsink);
+        }
+        entries->push(h.release(), xsink);
     }
+
+    ReferenceHolder<QoreHashNode> rv(new QoreHashNode(hashdeclZipVerifyReport, xsink), xsink);
+    rv->setKeyValue("ok", !errors, xsink);
+    rv->setKeyValue("count", (int64)count, xsink);
+    rv->setKeyValue("errors", errors, xsink);
+    rv->setKeyValue("size", total_size, xsink);
+    rv->setKeyValue("entries", entries.release(), xsink);
+    return rv.release();
 }
 
 void QoreZipFile::extractEntry(const char* name, const char* destPath, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return;
     }
 
@@ -737,17 +1860,18 @@ void QoreZipFile::extractEntry(const char* name, const char* destPath, Exception
         return;
     }
 
-    int32_t err = mz_zip_reader_locate_entry(reader, name, 0);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
         return;
     }
 
-    if (!password.empty()) {
-        mz_zip_reader_set_password(reader, password.c_str());
+    mz_zip_file* file_info = locateEntryUnlocked(holder.getZipHandle(), name, xsink);
+    if (!file_info) {
+        return;
     }
 
-    err = mz_zip_reader_entry_save_file(reader, destPath);
+    int32_t err = ZipExtractor::saveEntry(holder.getZipHandle(), file_info, destPath,
+        password.empty() ? nullptr : password.c_str());
     if (err != MZ_OK) {
         xsink->raiseException("ZIP-ERROR", "failed to extract entry '%s' to '%s': error %d", name, destPath, err);
     }
@@ -768,14 +1892,19 @@ QoreStringNode* QoreZipFile::getPath() const {
 }
 
 QoreStringNode* QoreZipFile::getComment(ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
+
+    if (!checkReadable(guard, xsink)) {
+        return nullptr;
+    }
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
         return nullptr;
     }
 
     const char* comment = nullptr;
-    int32_t err = mz_zip_reader_get_comment(reader, &comment);
+    int32_t err = mz_zip_reader_get_comment(holder.get(), &comment);
     if (err != MZ_OK || !comment) {
         return nullptr;
     }
@@ -820,28 +1949,29 @@ QoreStringNode* QoreZipEntry::getComment() const {
 }
 
 QoreObject* QoreZipFile::openInputStream(const char* name, ExceptionSink* xsink) {
-    QoreAutoRWReadLocker lock(rwlock);
+    ZipReadGuard guard(read_gate);
 
-    if (!checkOpenUnlocked(xsink, false)) {
+    if (!checkReadable(guard, xsink)) {
         return nullptr;
     }
 
-    // Locate the entry
-    int32_t err = mz_zip_reader_locate_entry(reader, name, 0);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-ERROR", "entry '%s' not found", name);
+    // The stream keeps its own reader handle, so that it is not affected by other operations on the archive
+    ZipReaderHolder holder(readers, xsink);
+    if (!holder) {
         return nullptr;
     }
 
-    if (!password.empty()) {
-        mz_zip_reader_set_password(reader, password.c_str());
+    // Locate the entry
+    if (!locateEntryUnlocked(holder.getZipHandle(), name, xsink)) {
+        return nullptr;
     }
 
     // Increment active stream count
     ++active_streams;
 
-    // Create the stream - it will open the entry
-    ReferenceHolder<ZipInputStream> stream(new ZipInputStream(this, reader, name, xsink), xsink);
+    // Create the stream - it will open the entry and return the reader handle when destroyed
+    ReferenceHolder<ZipInputStream> stream(new ZipInputStream(this, holder.release(), name,
+        password.empty() ? nullptr : password.c_str(), xsink), xsink);
     if (*xsink) {
         --active_streams;
         return nullptr;
@@ -851,7 +1981,8 @@ QoreObject* QoreZipFile::openInputStream(const char* name, ExceptionSink* xsink)
 }
 
 QoreObject* QoreZipFile::openOutputStream(const char* name, const QoreHashNode* opts, ExceptionSink* xsink) {
-    QoreAutoRWWriteLocker lock(rwlock);
+    // The entry is spooled and added when the stream is closed, so no archive lock is held while it is written
+    QoreAutoRWReadLocker lock(rwlock);
 
     if (!checkOpenUnlocked(xsink, true)) {
         return nullptr;
@@ -861,20 +1992,40 @@ QoreObject* QoreZipFile::openOutputStream(const char* name, const QoreHashNode*
     std::string entry_password, comment;
     int64 modified_time;
     parseAddOptions(opts, compression_method, compression_level, entry_password, comment, modified_time, xsink);
+    int64 entry_threads = getEntryThreadCount(opts, xsink);
+    if (entry_threads < 0) {
+        return nullptr;
+    }
 
-    if (!entry_password.empty()) {
-        mz_zip_writer_set_password(writer, entry_password.c_str());
-        mz_zip_writer_set_aes(writer, 1);
+    int64 pipeline_buffers = 0;
+    if (opts) {
+        pipeline_buffers = opts->getKeyValue("pipeline_buffers").getAsBigInt();
+        if (pipeline_buffers < 0) {
+            xsink->raiseException("ZIP-ERROR", "invalid pipeline buffer count %lld; expecting 0 or a positive number",
+                                  (long long)pipeline_buffers);
+            return nullptr;
+        }
     }
 
-    // Increment active stream count
+    std::unique_ptr<ZipWriteEntry> entry(new ZipWriteEntry);
+    entry->name = name;
+    entry->comment = comment;
+    entry->modified = modified_time ? modified_time : time(nullptr);
+    entry->compression_method = compression_method;
+    entry->compression_level = compression_level;
+    entry->threads = (unsigned)entry_threads;
+    entry->long_window = getLongWindow(opts, compression_method);
+
+    // Unencrypted data is compressed by the module as it is written; other data is compressed and encrypted by
+    // minizip as it is written
+    bool raw = ZipParallelWriter::canCompress(compression_method, !entry_password.empty());
+
+    // Increment active stream count; it is decremented by the stream's destructor
     ++active_streams;
 
-    // Create the stream - it will open the entry
-    ReferenceHolder<ZipOutputStream> stream(
-        new ZipOutputStream(this, writer, name, compression_method, compression_level, xsink), xsink);
+    ReferenceHolder<ZipOutputStream> stream(new ZipOutputStream(this, entry.release(), raw, entry_password,
+        (size_t)pipeline_buffers, xsink), xsink);
     if (*xsink) {
-        --active_streams;
         return nullptr;
     }
 
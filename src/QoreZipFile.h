@@ -28,16 +28,30 @@
 #define _QORE_ZIP_QOREZIPFILE_H
 
 #include "zip-module.h"
+#include "ZipEntryIndex.h"
+#include "ZipReaderPool.h"
+#include "ZipReadGate.h"
+#include "ZipJob.h"
+#include "ZipParallelWriter.h"
 
 #include <string>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 //! Default maximum size for memory allocations (1GB)
 #define ZIP_DEFAULT_MAX_ALLOC_SIZE (1024LL * 1024 * 1024)
 
+//! Maximum number of worker threads for extracting or verifying an archive
+#define ZIP_MAX_THREADS 256
+
 //! Default memory stream grow size (128KB)
 #define ZIP_MEM_STREAM_GROW_SIZE (128 * 1024)
 
+class QoreZipEntry;
+struct ZipExtractPlan;
+
 // Open modes
 enum ZipMode {
     ZIP_MODE_READ = 0,
@@ -50,11 +64,16 @@ enum ZipMode {
 /** This class is thread-safe. All public methods acquire appropriate locks.
     However, stream objects (ZipInputStream, ZipOutputStream) are not thread-safe
     and should only be used from a single thread.
+
+    Read operations only take the read lock and check out their own reader handle from a ZipReaderPool, so
+    entries can be read and decompressed by several threads in parallel.
 */
 class QoreZipFile : public AbstractPrivateData {
 public:
     //! Constructor for file-based archive
-    DLLLOCAL QoreZipFile(const char* path, ZipMode mode, ExceptionSink* xsink);
+    /** @param opts optional ZipOpenOptions hash
+    */
+    DLLLOCAL QoreZipFile(const char* path, ZipMode mode, const QoreHashNode* opts, ExceptionSink* xsink);
 
     //! Constructor for in-memory archive (from binary data)
     DLLLOCAL QoreZipFile(const BinaryNode* data, ExceptionSink* xsink);
@@ -71,6 +90,14 @@ public:
     //! Check if there are active streams
     DLLLOCAL bool hasActiveStreams() const { return active_streams > 0; }
 
+    //! Mark an asynchronous job as pending (must be called in a read guard)
+    /** close() waits until all pending jobs have called derefJob()
+    */
+    DLLLOCAL void refJob();
+
+    //! Mark an asynchronous job as complete; may be called in any thread
+    DLLLOCAL void derefJob();
+
     //! Get the maximum allocation size
     DLLLOCAL int64 getMaxAllocSize() const { return max_alloc_size; }
 
@@ -89,15 +116,45 @@ public:
     //! Get list of all entries
     DLLLOCAL QoreListNode* entries(ExceptionSink* xsink);
 
+    //! Get the metadata of all entries as parallel lists
+    DLLLOCAL QoreHashNode* entriesColumnar(ExceptionSink* xsink);
+
+    //! Get entries whose names start with the given prefix or match the given glob pattern
+    DLLLOCAL QoreListNode* list(const char* pattern, ExceptionSink* xsink);
+
+    //! Get the immediate children of the given directory
+    DLLLOCAL QoreListNode* listDirectory(const char* prefix, ExceptionSink* xsink);
+
+    //! Get the entry following the given entry index position
+    /** @param pos the central directory order position of the current entry, or -1 for the first entry;
+        updated to the position of the returned entry
+
+        @return the next entry, or nullptr if there are no more entries or an exception was raised
+    */
+    DLLLOCAL QoreZipEntry* nextEntry(int64& pos, ExceptionSink* xsink);
+
+    //! Create an iterator over the entries of the archive
+    DLLLOCAL QoreObject* iterator(ExceptionSink* xsink);
+
     //! Get number of entries
     DLLLOCAL int64 count(ExceptionSink* xsink);
 
+    //! Get archive totals collected when the archive was opened
+    DLLLOCAL QoreHashNode* summary(ExceptionSink* xsink);
+
     //! Check if entry exists
     DLLLOCAL bool hasEntry(const char* name, ExceptionSink* xsink);
 
     //! Read entry as binary data
     DLLLOCAL BinaryNode* read(const char* name, ExceptionSink* xsink);
 
+    //! Read several entries in the order their data is stored in the archive
+    /** @param names a list of entry names (strings)
+
+        @return a hash of binary data keyed by entry name in the requested order
+    */
+    DLLLOCAL QoreHashNode* readMany(const QoreListNode* names, ExceptionSink* xsink);
+
     //! Read entry as text
     DLLLOCAL QoreStringNode* readText(const char* name, const char* encoding, ExceptionSink* xsink);
 
@@ -114,12 +171,27 @@ public:
     //! Add file from filesystem
     DLLLOCAL void addFile(const char* name, const char* filepath, const QoreHashNode* opts, ExceptionSink* xsink);
 
+    //! Add all files and directories under a directory, reading and compressing files in parallel
+    DLLLOCAL void addTree(const char* dir, const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Add a list of files, reading and compressing them in parallel
+    DLLLOCAL void addFiles(const QoreListNode* specs, const QoreHashNode* opts, ExceptionSink* xsink);
+
     //! Add directory entry
     DLLLOCAL void addDirectory(const char* name, ExceptionSink* xsink);
 
     //! Extract all entries to directory
     DLLLOCAL void extractAll(const char* destPath, const QoreHashNode* opts, ExceptionSink* xsink);
 
+    //! Start reading an entry in a background thread; returns a ZipJob object
+    DLLLOCAL QoreObject* readAsync(const char* name, ExceptionSink* xsink);
+
+    //! Start extracting all entries to a directory in a background thread; returns a ZipJob object
+    DLLLOCAL QoreObject* extractAllAsync(const char* destPath, const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Verify the data of all entries against the central directory
+    DLLLOCAL QoreHashNode* verify(const QoreHashNode* opts, ExceptionSink* xsink);
+
     //! Extract single entry
     DLLLOCAL void extractEntry(const char* name, const char* destPath, ExceptionSink* xsink);
 
@@ -141,8 +213,18 @@ public:
     //! Open an output stream for writing an entry
     DLLLOCAL QoreObject* openOutputStream(const char* name, const QoreHashNode* opts, ExceptionSink* xsink);
 
-    //! Get reader handle (for stream classes)
-    DLLLOCAL void* getReader() const { return reader; }
+    //! Add the entry spooled by a ZipOutputStream to the archive
+    /** Takes the archive write lock for the copy only.
+
+        @param entry the entry with the spooled data
+        @param entry_reader a minizip reader positioned on the entry in the private archive it was compressed into
+        by minizip, or nullptr if the data was compressed by the module and is in the spool of \a entry
+        @param xsink exception sink
+    */
+    DLLLOCAL void commitStreamEntry(ZipWriteEntry& entry, void* entry_reader, ExceptionSink* xsink);
+
+    //! Return a reader handle checked out for an input stream
+    DLLLOCAL void releaseReader(void* reader) { readers.release(reader); }
 
     //! Get writer handle (for stream classes)
     DLLLOCAL void* getWriter() const { return writer; }
@@ -151,17 +233,41 @@ private:
     mutable QoreRWLock rwlock;          //!< Read-write lock for thread safety
     std::string filepath;
     ZipMode mode;
-    void* reader;                        //!< mz_zip_reader handle
     void* writer;                        //!< mz_zip_writer handle
+    std::unique_ptr<ZipParallelWriter> parallel_writer;  //!< set if entries are compressed in parallel
     void* mem_stream;                    //!< memory stream for in-memory archives
     std::string password;
     bool in_memory;
-    bool closed;
+    std::atomic<bool> closed;            //!< Set under the write lock, read without a lock by read operations
+    ZipReaderPool readers;               //!< Reader handles, one per concurrent read operation
     std::atomic<int> active_streams;     //!< Count of active stream objects
-    int64 max_alloc_size;                //!< Maximum size for memory allocations
 
-    //! Create ZipEntryInfo hash from minizip file info
-    DLLLOCAL QoreHashNode* createEntryInfo(mz_zip_file* file_info, ExceptionSink* xsink);
+    //! @name Pending asynchronous jobs
+    //@{
+    std::mutex job_lock;
+    std::condition_variable job_cond;   //!< signaled when the last pending job has completed
+    int active_jobs = 0;
+    //@}
+    std::atomic<int64> max_alloc_size;   //!< Maximum size for memory allocations
+
+    //! Admits read operations without locking; open while the index and reader pool can be used
+    /** The index and reader pool are not modified while the gate is open; close() shuts the gate and waits for
+        all read operations in progress before releasing them
+    */
+    ZipReadGate read_gate;
+    std::shared_ptr<const ZipEntryIndex> index;  //!< Entry metadata index, set when opened for reading
+
+    //! Create ZipEntryInfo hash from entry metadata
+    DLLLOCAL static QoreHashNode* createEntryInfo(const char* name, int64 size, int64 compressed_size,
+                                                  int64 modified, int64 crc, int compression_method,
+                                                  bool is_encrypted, const char* comment, size_t comment_len,
+                                                  ExceptionSink* xsink);
+
+    //! Create ZipEntryInfo hash for the entry at the given index position (must be called in a read guard)
+    DLLLOCAL QoreHashNode* createEntryInfo(size_t i, ExceptionSink* xsink);
+
+    //! Create ZipEntry private data for the entry at the given index position (must be called in a read guard)
+    DLLLOCAL QoreZipEntry* createEntry(size_t i) const;
 
     //! Parse add options
     DLLLOCAL void parseAddOptions(const QoreHashNode* opts, int16_t& compression_method, int16_t& compression_level,
@@ -171,17 +277,130 @@ private:
     //! Check archive is open and in correct mode (must be called with lock held)
     DLLLOCAL bool checkOpenUnlocked(ExceptionSink* xsink, bool forWrite = false);
 
+    //! Check that the given read guard has entered the read gate; raises an exception if not
+    DLLLOCAL bool checkReadable(const ZipReadGuard& guard, ExceptionSink* xsink) const;
+
     //! Open for reading
-    DLLLOCAL void openRead(ExceptionSink* xsink);
+    DLLLOCAL void openRead(const QoreHashNode* opts, ExceptionSink* xsink);
 
     //! Open for writing
-    DLLLOCAL void openWrite(ExceptionSink* xsink);
+    DLLLOCAL void openWrite(const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Write the entries queued for parallel compression (must be called with write lock held)
+    /** @return 0 on success, -1 if an entry could not be added (an exception is raised)
+    */
+    DLLLOCAL int flushUnlocked(ExceptionSink* xsink);
+
+    //! Build the entry index with a reader handle from the pool
+    /** @param data the raw archive data for the native central directory parser
+    */
+    DLLLOCAL bool buildIndex(const ZipArchiveData* data, ExceptionSink* xsink);
+
+    //! Position the given mz_zip handle on the given entry using the index (must be called in a read guard)
+    /** @return the entry info, or nullptr if the entry does not exist (an exception is raised)
+    */
+    DLLLOCAL mz_zip_file* locateEntryUnlocked(void* zip_handle, const char* name, ExceptionSink* xsink);
+
+    //! Position the given mz_zip handle on the entry at the given central directory position
+    /** @return the entry info, or nullptr on error
+    */
+    DLLLOCAL static mz_zip_file* gotoEntry(void* zip_handle, int64 cd_pos);
+
+    //! Copy the data of a stored entry directly from the memory-mapped archive (must be called in a read guard)
+    /** @param i the position of the entry in the index
+        @param name the name of the entry
+        @param data set to the entry data
+
+        @return true if the entry was read or an exception was raised, false if the entry is not stored without
+        encryption or the archive is not memory-mapped, in which case the entry must be read with minizip
+    */
+    DLLLOCAL bool readMappedUnlocked(int64 i, const char* name, BinaryNode*& data, ExceptionSink* xsink);
+
+    //! Read the data of the entry the given mz_zip handle is positioned on (must be called in a read guard)
+    DLLLOCAL BinaryNode* readEntryUnlocked(void* zip_handle, const char* name, mz_zip_file* file_info,
+                                           ExceptionSink* xsink);
+
+    //! Read the data of the entry the given mz_zip handle is positioned on into a new malloc()ed buffer
+    /** Does not use the Qore API, so it can also be called in background threads; \a buf is nullptr for empty
+        entries
+
+        @return 0 on success, -1 on error (\a error is set)
+    */
+    DLLLOCAL static int readEntryData(void* zip_handle, const char* name, const mz_zip_file* file_info,
+                                      const char* entry_password, int64 max_alloc_size, char*& buf, int64& len,
+                                      QoreString& error);
+
+    //! Returns the number of worker threads from the \c threads option (must be called in a read guard)
+    /** When the archive is opened for reading, the number of threads is limited to the number of entries
+
+        @return the number of threads (at least 1), or -1 if the option is invalid (an exception is raised)
+    */
+    DLLLOCAL int64 getThreadCount(const QoreHashNode* opts, ExceptionSink* xsink) const;
+
+    //! Returns the number of threads from the \c threads option, or 1 if the option is not given
+    /** @return the number of threads (at least 1), or -1 if the option is invalid (an exception is raised)
+    */
+    DLLLOCAL static int64 parseThreadCount(const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Parse the options for addTree() and addFiles()
+    /** @return 0 on success, -1 on error (an exception is raised)
+    */
+    DLLLOCAL int parseBatchOptions(const QoreHashNode* opts, int16_t& compression_method, int16_t& compression_level,
+                                   int64& threads, ExceptionSink* xsink);
+
+    //! Compress and write the given entries with the given number of threads under the write lock
+    DLLLOCAL void addBatch(ZipWriteEntryList& entries, unsigned threads, ExceptionSink* xsink);
+
+    //! Returns the number of threads compressing a single entry from the \c threads add option
+    /** @return the number of threads, 0 if the option is not given, or -1 if the option is invalid (an exception is
+        raised)
+    */
+    DLLLOCAL static int64 getEntryThreadCount(const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Returns true if the \c long_window add option is set for a zstd entry
+    DLLLOCAL static bool getLongWindow(const QoreHashNode* opts, int16_t compression_method);
+
+    //! Start the given operation as an asynchronous job (must be called in a read guard)
+    /** @return a new ZipJob object, or nullptr if the job could not be started (an exception is raised)
+    */
+    DLLLOCAL QoreObject* startJobUnlocked(const zip_job_func_t& func, ExceptionSink* xsink);
+
+    //! Validate the destination and all entry paths and collect the entries to extract (must be called in a read guard)
+    /** @return 0 on success, -1 on error (an exception is raised)
+    */
+    DLLLOCAL int prepareExtractUnlocked(const char* destPath, const QoreHashNode* opts, ZipExtractPlan& plan,
+                                        ExceptionSink* xsink);
 
     //! Validate path for extraction (check for path traversal)
     DLLLOCAL static bool validateExtractPath(const char* entry_name, const char* dest_path, ExceptionSink* xsink);
 
     //! Add binary data as entry (must be called with write lock held)
     DLLLOCAL void addUnlocked(const char* name, const BinaryNode* data, const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Queue an entry for the parallel writer (must be called with write lock held)
+    /** Takes ownership of the entry
+    */
+    DLLLOCAL void addEntryUnlocked(ZipWriteEntry* entry, ExceptionSink* xsink);
+
+    //! Compress an entry before the write lock is taken
+    /** Entries that the module can compress (see ZipParallelWriter::canCompress()) are compressed in the calling
+        thread without holding the write lock, so that threads adding entries to the same archive compress them at
+        the same time; the write lock is then only held to write the compressed entry with writeEntryUnlocked().
+
+        @param name the entry name
+        @param data the entry data, or nullptr if the data is read from \a filepath
+        @param filepath the source file if \a data is nullptr
+        @param opts the add options
+        @param xsink exception sink
+
+        @return the compressed entry, or nullptr if the entry must be added with the write lock held (also if the
+        archive is in parallel mode) or if an exception was raised
+    */
+    DLLLOCAL ZipWriteEntry* compressEntry(const char* name, const BinaryNode* data, const char* filepath,
+                                          const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! Write an entry compressed with compressEntry() to the archive (must be called with write lock held)
+    DLLLOCAL void writeEntryUnlocked(ZipWriteEntry& entry, ExceptionSink* xsink);
 };
 
 //! QoreZipEntry - private data class for ZipEntry Qore class
@@ -0,0 +1,200 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipBlockDeflater.cpp ZipBlockDeflater class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipBlockDeflater.h"
+
+#include <mz_crypt.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+ZipBlockDeflater::ZipBlockDeflater(int level, unsigned threads, const sink_t& sink)
+    : ZipEntryCompressor(sink), level(level), threads(threads ? threads : 1), max_pending(this->threads * 2),
+      current(new Block), group(this->threads, max_pending) {
+    current->in.reserve(ZIP_DEFLATE_BLOCK_SIZE);
+}
+
+ZipBlockDeflater::~ZipBlockDeflater() {
+    // No task may run after the blocks have been deleted
+    group.cancel();
+    group.wait();
+    for (Block* block : pending) {
+        delete block;
+    }
+}
+
+int32_t ZipBlockDeflater::write(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len && err == MZ_OK && !finished) {
+        size_t n = std::min(len, ZIP_DEFLATE_BLOCK_SIZE - current->in.size());
+        current->in.insert(current->in.end(), p, p + n);
+        p += n;
+        len -= n;
+        if (current->in.size() == ZIP_DEFLATE_BLOCK_SIZE) {
+            submit(false);
+        }
+    }
+    return finished && err == MZ_OK ? MZ_PARAM_ERROR : err;
+}
+
+int32_t ZipBlockDeflater::finish() {
+    if (!finished) {
+        finished = true;
+        if (err == MZ_OK) {
+            submit(true);
+        }
+    }
+    return err;
+}
+
+int32_t ZipBlockDeflater::submit(bool last) {
+    Block* block = current.release();
+    block->last = last;
+    pending.push_back(block);
+
+    if (!last) {
+        // The next block is compressed with the end of this one as its dictionary
+        current.reset(new Block);
+        size_t n = std::min(block->in.size(), (size_t)ZIP_DEFLATE_DICT_SIZE);
+        current->dict.assign(block->in.end() - n, block->in.end());
+        current->in.reserve(ZIP_DEFLATE_BLOCK_SIZE);
+    }
+
+    if (threads == 1) {
+        compress(*block, level);
+        block->done = true;
+    } else {
+        group.add([this, block] () {
+            compress(*block, level);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                block->done = true;
+            }
+            cond.notify_all();
+        });
+    }
+
+    return writeQueued(last ? 0 : max_pending);
+}
+
+int32_t ZipBlockDeflater::writeQueued(size_t keep) {
+    while (!pending.empty()) {
+        Block* block = pending.front();
+        bool done;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done = block->done;
+        }
+        if (!done) {
+            if (pending.size() <= keep) {
+                break;
+            }
+            waitFor(block);
+        }
+
+        pending.pop_front();
+        std::unique_ptr<Block> holder(block);
+        if (err != MZ_OK) {
+            continue;
+        }
+        if (block->err != MZ_OK) {
+            err = block->err;
+            continue;
+        }
+        if (!block->out.empty() && output(&block->out[0], block->out.size())) {
+            continue;
+        }
+        crc = (uint32_t)crc32_combine(crc, block->crc, (z_off_t)block->in_size);
+        size += block->in_size;
+    }
+    return err;
+}
+
+void ZipBlockDeflater::waitFor(Block* block) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (block->done) {
+                return;
+            }
+        }
+        // If no task is queued, the block is being compressed by a pool thread
+        if (!group.runOne()) {
+            break;
+        }
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (!block->done) {
+        cond.wait(guard);
+    }
+}
+
+void ZipBlockDeflater::compress(Block& block, int level) {
+    block.in_size = block.in.size();
+    if (block.in_size) {
+        block.crc = mz_crypt_crc32_update(0, (const uint8_t*)&block.in[0], (int32_t)block.in_size);
+    }
+
+    // The same parameters as minizip's deflate stream: raw deflate with the default window and memory level
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        block.err = MZ_PARAM_ERROR;
+        return;
+    }
+    if (!block.dict.empty()
+        && deflateSetDictionary(&zs, (const Bytef*)&block.dict[0], (uInt)block.dict.size()) != Z_OK) {
+        deflateEnd(&zs);
+        block.err = MZ_PARAM_ERROR;
+        return;
+    }
+
+    // The bound does not include the marker of the sync flush, so the buffer grows if necessary
+    block.out.resize(deflateBound(&zs, (uLong)block.in_size) + 16);
+    zs.next_in = block.in_size ? (Bytef*)&block.in[0] : nullptr;
+    zs.avail_in = (uInt)block.in_size;
+    size_t have = 0;
+    while (true) {
+        zs.next_out = (Bytef*)&block.out[have];
+        zs.avail_out = (uInt)(block.out.size() - have);
+        if (deflate(&zs, block.last ? Z_FINISH : Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+            block.err = MZ_DATA_ERROR;
+            break;
+        }
+        have = block.out.size() - zs.avail_out;
+        if (zs.avail_out) {
+            break;
+        }
+        block.out.resize(block.out.size() * 2);
+    }
+    deflateEnd(&zs);
+
+    block.out.resize(have);
+    std::vector<char>().swap(block.in);
+    std::vector<char>().swap(block.dict);
+}
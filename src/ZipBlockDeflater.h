@@ -0,0 +1,114 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipBlockDeflater.h ZipBlockDeflater class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPBLOCKDEFLATER_H
+#define _QORE_ZIP_ZIPBLOCKDEFLATER_H
+
+#include "zip-module.h"
+#include "ZipEntryCompressor.h"
+#include "ZipThreadPool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//! Size of the blocks of entry data compressed in parallel by a ZipBlockDeflater (128KB)
+#define ZIP_DEFLATE_BLOCK_SIZE (128 * 1024)
+
+//! Size of the deflate window; the end of each block primes the compression of the next block (32KB)
+#define ZIP_DEFLATE_DICT_SIZE (32 * 1024)
+
+//! ZipBlockDeflater - compresses the data of one entry in blocks in parallel into a single raw deflate stream
+/** The data is split into blocks of ZIP_DEFLATE_BLOCK_SIZE bytes, which are compressed by the calling thread and
+    the pool threads of a ZipTaskGroup.  Each block is compressed with the last ZIP_DEFLATE_DICT_SIZE bytes of the
+    previous block as its dictionary and ends on a byte boundary (\c Z_SYNC_FLUSH), except the last block, which
+    ends the stream (\c Z_FINISH), so the blocks concatenated in order form one standard deflate stream.  The CRC32
+    of the data is combined from the CRC32 of the blocks.
+
+    The compressed data only depends on the compression level and the data, not on the number of threads.  At most
+    twice the number of threads blocks are compressed or waiting to be written at any time.
+
+    Does not use the Qore API; all methods must be called in the same thread, which is also the thread the
+    compressed data is written in.
+*/
+class ZipBlockDeflater : public ZipEntryCompressor {
+public:
+    //! Creates the deflater
+    /** @param level the deflate compression level
+        @param threads the number of threads including the calling thread
+        @param sink called with the compressed data in order
+    */
+    DLLLOCAL ZipBlockDeflater(int level, unsigned threads, const sink_t& sink);
+
+    //! Discards blocks that have not been written yet
+    DLLLOCAL virtual ~ZipBlockDeflater();
+
+    //! Adds data to be compressed; complete blocks are queued for compression
+    /** Compressed blocks at the head of the queue are written to the sink.
+    */
+    DLLLOCAL virtual int32_t write(const void* data, size_t len) override;
+
+    //! Compresses the remaining data, ends the stream and writes all remaining compressed data to the sink
+    DLLLOCAL virtual int32_t finish() override;
+
+private:
+    //! A block of data
+    struct Block {
+        std::vector<char> dict;         //!< the end of the previous block
+        std::vector<char> in;           //!< the uncompressed data; released when compressed
+        std::vector<char> out;          //!< the compressed data
+        size_t in_size = 0;
+        uint32_t crc = 0;
+        int32_t err = MZ_OK;
+        bool last = false;              //!< true if the block ends the stream
+        bool done = false;              //!< set under the lock when compression is complete
+    };
+
+    int level;
+    unsigned threads;
+    size_t max_pending;                 //!< the maximum number of blocks compressed or waiting to be written
+    std::mutex lock;
+    std::condition_variable cond;       //!< signaled when a block has been compressed
+    std::unique_ptr<Block> current;     //!< the block being filled
+    std::deque<Block*> pending;         //!< blocks not yet written, in order
+    ZipTaskGroup group;
+
+    //! Queues the current block for compression and starts the next one
+    DLLLOCAL int32_t submit(bool last);
+
+    //! Writes compressed blocks at the head of the queue; waits for blocks while more than \a keep are queued
+    DLLLOCAL int32_t writeQueued(size_t keep);
+
+    //! Waits until the given block has been compressed, running queued tasks in the calling thread meanwhile
+    DLLLOCAL void waitFor(Block* block);
+
+    //! Compresses a block
+    DLLLOCAL static void compress(Block& block, int level);
+};
+
+#endif // _QORE_ZIP_ZIPBLOCKDEFLATER_H
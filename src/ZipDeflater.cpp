@@ -0,0 +1,97 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipDeflater.cpp ZipDeflater class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ZipDeflater.h"
+
+#include <mz_crypt.h>
+
+#include <algorithm>
+#include <cstring>
+
+//! Maximum size of one chunk of data passed to zlib
+#define ZIP_DEFLATE_MAX_CHUNK (1 << 30)
+
+//! Size of the buffer for compressed data (256KB)
+#define ZIP_DEFLATE_OUT_SIZE (256 * 1024)
+
+ZipDeflater::ZipDeflater(int level, const sink_t& sink) : ZipEntryCompressor(sink), out_buf(ZIP_DEFLATE_OUT_SIZE) {
+    // The same parameters as minizip's deflate stream: raw deflate with the default window and memory level
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        err = MZ_PARAM_ERROR;
+        return;
+    }
+    initialized = true;
+}
+
+ZipDeflater::~ZipDeflater() {
+    if (initialized) {
+        deflateEnd(&zs);
+    }
+}
+
+int32_t ZipDeflater::write(const void* data, size_t len) {
+    if (finished) {
+        return err == MZ_OK ? MZ_PARAM_ERROR : err;
+    }
+
+    const char* p = (const char*)data;
+    for (size_t done = 0; done < len && err == MZ_OK; ) {
+        size_t n = std::min(len - done, (size_t)ZIP_DEFLATE_MAX_CHUNK);
+        crc = mz_crypt_crc32_update(crc, (const uint8_t*)p + done, (int32_t)n);
+        size += n;
+        compress(p + done, n, Z_NO_FLUSH);
+        done += n;
+    }
+    return err;
+}
+
+int32_t ZipDeflater::finish() {
+    if (!finished) {
+        finished = true;
+        if (err == MZ_OK) {
+            compress(nullptr, 0, Z_FINISH);
+        }
+    }
+    return err;
+}
+
+int32_t ZipDeflater::compress(const char* data, size_t len, int flush) {
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = (uInt)len;
+    do {
+        zs.next_out = (Bytef*)&out_buf[0];
+        zs.avail_out = (uInt)out_buf.size();
+        if (deflate(&zs, flush) == Z_STREAM_ERROR) {
+            return err = MZ_DATA_ERROR;
+        }
+        if (output(&out_buf[0], out_buf.size() - zs.avail_out)) {
+            return err;
+        }
+    } while (!zs.avail_out);
+    return MZ_OK;
+}
@@ -0,0 +1,66 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipDeflater.h ZipDeflater class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _QORE_ZIP_ZIPDEFLATER_H
+#define _QORE_ZIP_ZIPDEFLATER_H
+
+#include "zip-module.h"
+#include "ZipEntryCompressor.h"
+
+#include <vector>
+
+#include <zlib.h>
+
+//! ZipDeflater - compresses the data of one entry into a raw deflate stream in the calling thread
+/** Uses the same deflate parameters as minizip's deflate stream.
+
+    Does not use the Qore API; all methods must be called in the same thread.
+*/
+class ZipDeflater : public ZipEntryCompressor {
+public:
+    //! Creates the deflater
+    /** @param level the deflate compression level
+        @param sink called with the compressed data in order
+    */
+    DLLLOCAL ZipDeflater(int level, const sink_t& sink);
+
+    DLLLOCAL virtual ~ZipDeflater();
+
+    DLLLOCAL virtual int32_t write(const void* data, size_t len) override;
+
+    DLLLOCAL virtual int32_t finish() override;
+
+private:
+    z_stream zs;
+    bool initialized = false;
+    std::vector<char> out_buf;
+
+    //! Compresses the given input with the given flush mode until it has been consumed or the stream has ended
+    DLLLOCAL int32_t compress(const char* data, size_t len, int flush);
+};
+
+#endif // _QORE_ZIP_ZIPDEFLATER_H
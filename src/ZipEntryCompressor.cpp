@@ -0,0 +1,59 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryCompressor.cpp ZipEntryCompressor class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipEntryCompressor.h"
+#include "ZipBlockDeflater.h"
+#include "ZipDeflater.h"
+#include "ZipZstdCompressor.h"
+
+ZipEntryCompressor* ZipEntryCompressor::create(int16_t compression_method, int16_t compression_level,
+                                               unsigned threads, bool long_window, const sink_t& sink) {
+    switch (compression_method) {
+        case MZ_COMPRESS_METHOD_DEFLATE:
+            if (!threads) {
+                return new ZipDeflater(compression_level, sink);
+            }
+            return new ZipBlockDeflater(compression_level, threads, sink);
+#ifdef HAVE_ZSTD
+        case MZ_COMPRESS_METHOD_ZSTD:
+            return new ZipZstdCompressor(compression_level, threads, long_window, sink);
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+bool ZipEntryCompressor::isSupported(int16_t compression_method) {
+    switch (compression_method) {
+        case MZ_COMPRESS_METHOD_DEFLATE:
+#ifdef HAVE_ZSTD
+        case MZ_COMPRESS_METHOD_ZSTD:
+#endif
+            return true;
+        default:
+            return false;
+    }
+}
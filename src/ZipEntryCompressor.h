@@ -0,0 +1,119 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryCompressor.h ZipEntryCompressor class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPENTRYCOMPRESSOR_H
+#define _QORE_ZIP_ZIPENTRYCOMPRESSOR_H
+
+#include "zip-module.h"
+
+#include <functional>
+
+//! ZipEntryCompressor - compresses the data of one entry that is written to the archive as a raw entry
+/** The data is passed with write() and finish(); the compressed data is passed to the sink in order in the thread
+    calling these methods.  The CRC32 and size of the uncompressed data are calculated by the compressor.
+
+    Does not use the Qore API; all methods must be called in the same thread.
+*/
+class ZipEntryCompressor {
+public:
+    //! Writes compressed data; returns 0 on success or -1 on error
+    typedef std::function<int(const char*, size_t)> sink_t;
+
+    DLLLOCAL virtual ~ZipEntryCompressor() {
+    }
+
+    //! Creates a compressor for the given compression method
+    /** @param compression_method \c MZ_COMPRESS_METHOD_DEFLATE or \c MZ_COMPRESS_METHOD_ZSTD (see isSupported())
+        @param compression_level the compression level; \c MZ_COMPRESS_LEVEL_DEFAULT for the default level
+        @param threads the number of threads compressing the data; 0 to compress the data in the calling thread as a
+        single stream
+        @param long_window true to enable long distance matching for zstd
+        @param sink called with the compressed data in order
+
+        @return the new compressor, or nullptr if the compression method is not supported
+    */
+    DLLLOCAL static ZipEntryCompressor* create(int16_t compression_method, int16_t compression_level,
+                                               unsigned threads, bool long_window, const sink_t& sink);
+
+    //! Returns true if entries with the given compression method can be compressed by a compressor
+    DLLLOCAL static bool isSupported(int16_t compression_method);
+
+    //! Adds data to be compressed
+    /** @return MZ_OK on success, otherwise a minizip error code; once an error has occurred, it is returned by all
+        following calls
+    */
+    DLLLOCAL virtual int32_t write(const void* data, size_t len) = 0;
+
+    //! Compresses the remaining data, ends the compressed data and writes it to the sink
+    /** @return MZ_OK on success, otherwise a minizip error code
+    */
+    DLLLOCAL virtual int32_t finish() = 0;
+
+    //! Returns the CRC32 of the data compressed so far
+    DLLLOCAL uint32_t getCrc() const {
+        return crc;
+    }
+
+    //! Returns the number of bytes of uncompressed data compressed so far
+    DLLLOCAL int64 getSize() const {
+        return size;
+    }
+
+    //! Returns the number of bytes of compressed data written to the sink so far
+    DLLLOCAL int64 getCompressedSize() const {
+        return compressed_size;
+    }
+
+protected:
+    sink_t sink;
+    uint32_t crc = 0;
+    int64 size = 0;
+    int64 compressed_size = 0;
+    int32_t err = MZ_OK;
+    bool finished = false;
+
+    DLLLOCAL ZipEntryCompressor(const sink_t& sink) : sink(sink) {
+    }
+
+    //! Passes compressed data to the sink
+    /** @return MZ_OK on success, otherwise \c MZ_WRITE_ERROR (also set in \a err)
+    */
+    DLLLOCAL int32_t output(const char* buf, size_t len) {
+        if (len) {
+            if (sink(buf, len)) {
+                return err = MZ_WRITE_ERROR;
+            }
+            compressed_size += len;
+        }
+        return MZ_OK;
+    }
+
+private:
+    DLLLOCAL ZipEntryCompressor(const ZipEntryCompressor&) = delete;
+    DLLLOCAL ZipEntryCompressor& operator=(const ZipEntryCompressor&) = delete;
+};
+
+#endif // _QORE_ZIP_ZIPENTRYCOMPRESSOR_H
@@ -0,0 +1,872 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryIndex.cpp ZipEntryIndex class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipEntryIndex.h"
+
+#include <mz_crypt.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//! Index file format version; increment when the layout changes
+#define ZIP_INDEX_VERSION 2
+
+//! Number of bytes at the end of an archive covered by the index key checksum
+/** The end of central directory record with a maximum length comment and the ZIP64 end of central directory
+    locator and record fit in this range.
+*/
+#define ZIP_INDEX_KEY_TAIL (66 * 1024)
+
+static const char ZIP_INDEX_MAGIC[8] = {'Q', 'Z', 'I', 'P', 'I', 'D', 'X', '\0'};
+
+//! Written in native byte order to detect index files from machines with a different byte order
+#define ZIP_INDEX_BYTE_ORDER 0x01020304
+
+// ZIP format record signatures and sizes
+#define ZIP_SIG_LOCAL_HEADER        0x04034b50
+#define ZIP_SIG_CENTRAL_HEADER      0x02014b50
+#define ZIP_SIG_EOCD                0x06054b50
+#define ZIP_SIG_ZIP64_EOCD          0x06064b50
+#define ZIP_SIG_ZIP64_EOCD_LOCATOR  0x07064b50
+#define ZIP_LOCAL_HEADER_SIZE       30
+#define ZIP_CENTRAL_HEADER_SIZE     46
+#define ZIP_EOCD_SIZE               22
+#define ZIP_ZIP64_EOCD_SIZE         56
+#define ZIP_ZIP64_LOCATOR_SIZE      20
+#define ZIP_EOCD_MAX_SEARCH         (ZIP_EOCD_SIZE + 0xffff)
+
+// Extra field IDs handled by minizip when reading central directory records
+#define ZIP_EXTRA_ZIP64             0x0001
+#define ZIP_EXTRA_NTFS              0x000a
+#define ZIP_EXTRA_UNIX1             0x000d
+#define ZIP_EXTRA_AES               0x9901
+
+//! Header of the index block; all offsets are relative to the start of the block and 8-byte aligned
+struct ZipIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    ZipIndexKey key;
+    uint64_t block_size;
+
+    uint64_t entry_count;
+    uint64_t unique_count;
+    uint64_t bucket_count;
+    uint64_t method_count;
+    uint64_t comment_count;
+    uint64_t names_size;
+
+    int64_t total_size;
+    int64_t total_compressed_size;
+    int64_t directory_count;
+    int64_t encrypted_count;
+
+    uint64_t cd_pos_offset;
+    uint64_t name_off_offset;
+    uint64_t local_offset_offset;
+    uint64_t uncompressed_size_offset;
+    uint64_t compressed_size_offset;
+    uint64_t modified_offset;
+    uint64_t crc_offset;
+    uint64_t method_offset;
+    uint64_t flag_offset;
+    uint64_t attr_offset;
+    uint64_t buckets_offset;
+    uint64_t sorted_offset;
+    uint64_t methods_offset;
+    uint64_t comments_offset;
+    uint64_t names_offset;
+};
+
+//! Collects entry metadata before the index block is laid out
+class ZipIndexBuilder {
+public:
+    ZipIndexHeader h = ZipIndexHeader();
+
+    std::vector<int64> cd_pos;
+    std::vector<uint64_t> name_off;
+    std::vector<int64> local_offset;
+    std::vector<int64> uncompressed_size;
+    std::vector<int64> compressed_size;
+    std::vector<int64> modified;
+    std::vector<uint32_t> crc;
+    std::vector<uint16_t> method;
+    std::vector<uint16_t> flag;
+    std::vector<uint8_t> attr;
+    std::vector<uint64_t> comments;
+    std::string pool;
+    ZipEntryIndex::method_count_map_t method_counts;
+
+    DLLLOCAL void reserve(size_t n) {
+        cd_pos.reserve(n);
+        name_off.reserve(n + 1);
+        local_offset.reserve(n);
+        uncompressed_size.reserve(n);
+        compressed_size.reserve(n);
+        modified.reserve(n);
+        crc.reserve(n);
+        method.reserve(n);
+        flag.reserve(n);
+        attr.reserve(n);
+    }
+
+    DLLLOCAL void add(int64 entry_cd_pos, const char* name, size_t name_len, int64 entry_local_offset,
+                      int64 entry_size, int64 entry_compressed_size, int64 entry_modified, uint32_t entry_crc,
+                      uint16_t entry_method, uint16_t entry_flag, uint8_t entry_attr, const char* comment,
+                      size_t comment_len) {
+        if (comment_len) {
+            comments.push_back(((uint64_t)cd_pos.size() << 32) | comment_len);
+            comments.push_back(pool.size());
+            pool.append(comment, comment_len);
+            pool.push_back('\0');
+        }
+
+        cd_pos.push_back(entry_cd_pos);
+        name_off.push_back(pool.size());
+        // Names are truncated at embedded NUL characters like the C strings minizip returns
+        pool.append(name, strnlen(name, name_len));
+        pool.push_back('\0');
+        local_offset.push_back(entry_local_offset);
+        uncompressed_size.push_back(entry_size);
+        compressed_size.push_back(entry_compressed_size);
+        modified.push_back(entry_modified);
+        crc.push_back(entry_crc);
+        method.push_back(entry_method);
+        flag.push_back(entry_flag);
+        attr.push_back(entry_attr);
+
+        h.total_size += entry_size;
+        h.total_compressed_size += entry_compressed_size;
+        ++method_counts[entry_method];
+        if (entry_attr & ZipEntryIndex::ZIP_INDEX_ATTR_DIR) {
+            ++h.directory_count;
+        }
+        if (entry_flag & MZ_ZIP_FLAG_ENCRYPTED) {
+            ++h.encrypted_count;
+        }
+    }
+};
+
+namespace {
+// 64-bit FNV-1a; the hash must not change between processes, as it is stored in index files
+uint64_t hash_name(const char* name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (; *name; ++name) {
+        h ^= (unsigned char)*name;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// Checks that a section of count elements of the given size at the given offset fits in the block
+bool check_section(uint64_t offset, uint64_t count, uint64_t elem_size, uint64_t block_size) {
+    return !(offset & 7) && offset <= block_size && count <= (block_size - offset) / elem_size;
+}
+
+// Reserves space for a section of count elements of type T and returns its offset
+template <typename T>
+uint64_t place_section(uint64_t& pos, uint64_t count) {
+    uint64_t offset = pos;
+    pos = align8(pos + count * sizeof(T));
+    return offset;
+}
+
+template <typename T>
+void copy_section(char* block, uint64_t offset, const std::vector<T>& v) {
+    if (!v.empty()) {
+        memcpy(block + offset, &v[0], v.size() * sizeof(T));
+    }
+}
+
+int write_all(int fd, const char* buf, size_t len) {
+    while (len) {
+        ssize_t rc = write(fd, buf, len);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buf += rc;
+        len -= rc;
+    }
+    return 0;
+}
+
+// Little-endian field access for ZIP records
+uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint64_t get64(const uint8_t* p) {
+    return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+}
+
+int ZipIndexKey::read(int fd) {
+    struct stat st;
+    if (fstat(fd, &st)) {
+        return -1;
+    }
+
+    size = st.st_size;
+    mtime_sec = st.st_mtime;
+#ifdef __APPLE__
+    mtime_nsec = st.st_mtimespec.tv_nsec;
+#else
+    mtime_nsec = st.st_mtim.tv_nsec;
+#endif
+
+    size_t tail = size < ZIP_INDEX_KEY_TAIL ? (size_t)size : ZIP_INDEX_KEY_TAIL;
+    std::vector<uint8_t> buf(tail);
+    size_t done = 0;
+    while (done < tail) {
+        ssize_t rc = pread(fd, &buf[done], tail - done, size - tail + done);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            return -1;
+        }
+        done += rc;
+    }
+
+    eocd_crc = tail ? mz_crypt_crc32_update(0, &buf[0], (int32_t)tail) : 0;
+    return 0;
+}
+
+const uint8_t* ZipFileArchiveData::read(int64 offset, size_t len, std::vector<uint8_t>& buf) const {
+    if (offset < 0 || offset > file_size || (uint64_t)len > (uint64_t)(file_size - offset)) {
+        return nullptr;
+    }
+
+    buf.resize(len);
+    size_t done = 0;
+    while (done < len) {
+        ssize_t rc = pread(fd, &buf[done], len - done, offset + done);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            return nullptr;
+        }
+        done += rc;
+    }
+    return len ? &buf[0] : (const uint8_t*)"";
+}
+
+int32_t ZipEntryIndex::build(void* zip_handle, const ZipArchiveData* data) {
+    clear();
+
+    ZipIndexBuilder builder;
+    if (data) {
+        // The native parser is anchored to the first entry as minizip sees it, so that central directory
+        // positions are compatible with mz_zip_goto_entry()
+        mz_zip_file* file_info = nullptr;
+        if (mz_zip_goto_first_entry(zip_handle) == MZ_OK
+            && mz_zip_entry_get_info(zip_handle, &file_info) == MZ_OK
+            && !parse(*data, mz_zip_get_entry(zip_handle), file_info->filename, builder)) {
+            return layout(builder);
+        }
+        builder = ZipIndexBuilder();
+    }
+
+    int32_t err = walk(zip_handle, builder);
+    if (err != MZ_OK) {
+        return err;
+    }
+    return layout(builder);
+}
+
+int ZipEntryIndex::parse(const ZipArchiveData& data, int64 cd_pos_base, const char* first_name,
+                         ZipIndexBuilder& builder) {
+    int64 archive_size = data.size();
+    if (archive_size < ZIP_EOCD_SIZE) {
+        return -1;
+    }
+
+    // Find the end of central directory record, searching backwards over a possible archive comment
+    size_t tail_len = archive_size < ZIP_EOCD_MAX_SEARCH ? (size_t)archive_size : ZIP_EOCD_MAX_SEARCH;
+    std::vector<uint8_t> tail_buf;
+    const uint8_t* tail = data.read(archive_size - tail_len, tail_len, tail_buf);
+    if (!tail) {
+        return -1;
+    }
+    const uint8_t* eocd = nullptr;
+    for (size_t i = tail_len - ZIP_EOCD_SIZE + 1; i-- > 0; ) {
+        if (get32(tail + i) == ZIP_SIG_EOCD) {
+            eocd = tail + i;
+            break;
+        }
+    }
+    if (!eocd) {
+        return -1;
+    }
+    int64 eocd_pos = archive_size - tail_len + (eocd - tail);
+
+    // Split archives are left to minizip
+    if (get16(eocd + 4) || get16(eocd + 6)) {
+        return -1;
+    }
+    uint64_t entry_count = get16(eocd + 10);
+    uint64_t cd_size = get32(eocd + 12);
+    uint64_t cd_offset = get32(eocd + 16);
+    int64 shift = 0;
+
+    std::vector<uint8_t> zip64_buf;
+    const uint8_t* locator = eocd_pos >= ZIP_ZIP64_LOCATOR_SIZE
+        ? data.read(eocd_pos - ZIP_ZIP64_LOCATOR_SIZE, ZIP_ZIP64_LOCATOR_SIZE, zip64_buf) : nullptr;
+    if (locator && get32(locator) == ZIP_SIG_ZIP64_EOCD_LOCATOR) {
+        const uint8_t* eocd64 = data.read(get64(locator + 8), ZIP_ZIP64_EOCD_SIZE, zip64_buf);
+        if (!eocd64 || get32(eocd64) != ZIP_SIG_ZIP64_EOCD || get32(eocd64 + 16) || get32(eocd64 + 20)) {
+            return -1;
+        }
+        entry_count = get64(eocd64 + 32);
+        cd_size = get64(eocd64 + 40);
+        cd_offset = get64(eocd64 + 48);
+    } else if ((uint64_t)eocd_pos > cd_offset + cd_size) {
+        // Data prepended to the archive (self-extracting archives, for example) shifts all offsets
+        shift = eocd_pos - (cd_offset + cd_size);
+    }
+
+    if (cd_offset + shift > (uint64_t)archive_size || cd_size > archive_size - (cd_offset + shift)
+        || entry_count > cd_size / ZIP_CENTRAL_HEADER_SIZE) {
+        return -1;
+    }
+
+    std::vector<uint8_t> cd_buf;
+    const uint8_t* cd = data.read(cd_offset + shift, cd_size, cd_buf);
+    if (!cd) {
+        return -1;
+    }
+
+    builder.reserve(entry_count);
+    uint64_t pos = 0;
+    int64 last_dos_date = -1;
+    time_t last_time = 0;
+    for (uint64_t e = 0; e < entry_count; ++e) {
+        if (cd_size - pos < ZIP_CENTRAL_HEADER_SIZE) {
+            return -1;
+        }
+        const uint8_t* rec = cd + pos;
+        if (get32(rec) != ZIP_SIG_CENTRAL_HEADER) {
+            return -1;
+        }
+
+        uint16_t version_madeby = get16(rec + 4);
+        uint16_t entry_flag = get16(rec + 8);
+        uint16_t entry_method = get16(rec + 10);
+        uint32_t dos_date = get32(rec + 12);
+        uint32_t entry_crc = get32(rec + 16);
+        uint64_t entry_compressed_size = get32(rec + 20);
+        uint64_t entry_size = get32(rec + 24);
+        uint16_t name_len = get16(rec + 28);
+        uint16_t extra_len = get16(rec + 30);
+        uint16_t comment_len = get16(rec + 32);
+        uint32_t external_fa = get32(rec + 38);
+        uint64_t entry_local_offset = get32(rec + 42);
+
+        uint64_t rec_len = ZIP_CENTRAL_HEADER_SIZE + (uint64_t)name_len + extra_len + comment_len;
+        if (cd_size - pos < rec_len) {
+            return -1;
+        }
+        const char* name = (const char*)rec + ZIP_CENTRAL_HEADER_SIZE;
+        const uint8_t* extra = rec + ZIP_CENTRAL_HEADER_SIZE + name_len;
+        const char* comment = (const char*)extra + extra_len;
+
+        // Check that the native parser and minizip agree on where the directory starts
+        if (!e && (strncmp(first_name, name, name_len) || first_name[strnlen(name, name_len)])) {
+            return -1;
+        }
+
+        // Consecutive entries usually share the same timestamp
+        if (dos_date != last_dos_date) {
+            last_dos_date = dos_date;
+            last_time = mz_zip_dosdate_to_time_t(dos_date);
+        }
+        int64 entry_modified = last_time;
+
+        // Decode the extra fields that minizip uses to override header values
+        for (const uint8_t* p = extra, * end = extra + extra_len; end - p >= 4; ) {
+            uint16_t field_id = get16(p);
+            uint16_t field_len = get16(p + 2);
+            p += 4;
+            if (end - p < field_len) {
+                break;
+            }
+            const uint8_t* field = p;
+            const uint8_t* field_end = p + field_len;
+            p = field_end;
+
+            if (field_id == ZIP_EXTRA_ZIP64) {
+                if (entry_size == UINT32_MAX) {
+                    if (field_end - field < 8) {
+                        return -1;
+                    }
+                    entry_size = get64(field);
+                    field += 8;
+                }
+                if (entry_compressed_size == UINT32_MAX) {
+                    if (field_end - field < 8) {
+                        return -1;
+                    }
+                    entry_compressed_size = get64(field);
+                    field += 8;
+                }
+                if (entry_local_offset == UINT32_MAX) {
+                    if (field_end - field < 8) {
+                        return -1;
+                    }
+                    entry_local_offset = get64(field);
+                }
+            } else if (field_id == ZIP_EXTRA_NTFS && field_len >= 4) {
+                for (field += 4; field_end - field >= 4; ) {
+                    uint16_t attr_id = get16(field);
+                    uint16_t attr_len = get16(field + 2);
+                    field += 4;
+                    if (field_end - field < attr_len) {
+                        break;
+                    }
+                    // Modification time in 100ns intervals since 1601-01-01
+                    if (attr_id == 1 && attr_len == 24) {
+                        entry_modified = (int64)((get64(field) - 116444736000000000ULL) / 10000000);
+                    }
+                    field += attr_len;
+                }
+            } else if (field_id == ZIP_EXTRA_UNIX1 && field_len >= 8 && !entry_modified) {
+                entry_modified = get32(field + 4);
+            } else if (field_id == ZIP_EXTRA_AES && field_len >= 7) {
+                // The actual compression method of AES encrypted entries
+                entry_method = get16(field + 5);
+            }
+        }
+
+        uint8_t entry_attr = 0;
+        if (mz_zip_attrib_is_dir(external_fa, version_madeby) == MZ_OK
+            || (name_len && (name[name_len - 1] == '/' || name[name_len - 1] == '\\'))) {
+            entry_attr |= ZIP_INDEX_ATTR_DIR;
+        }
+
+        builder.add(cd_pos_base + pos, name, name_len, entry_local_offset, entry_size, entry_compressed_size,
+                    entry_modified, entry_crc, entry_method, entry_flag, entry_attr, comment, comment_len);
+        pos += rec_len;
+    }
+
+    return 0;
+}
+
+int32_t ZipEntryIndex::walk(void* zip_handle, ZipIndexBuilder& builder) {
+    // Pre-size the arrays from the entry count in the end of central directory record
+    uint64_t number_entry = 0;
+    if (mz_zip_get_number_entry(zip_handle, &number_entry) == MZ_OK) {
+        builder.reserve((size_t)number_entry);
+    }
+
+    int32_t err = mz_zip_goto_first_entry(zip_handle);
+    while (err == MZ_OK) {
+        mz_zip_file* file_info = nullptr;
+        err = mz_zip_entry_get_info(zip_handle, &file_info);
+        if (err != MZ_OK) {
+            break;
+        }
+
+        builder.add(mz_zip_get_entry(zip_handle), file_info->filename, strlen(file_info->filename),
+                    file_info->disk_offset, file_info->uncompressed_size, file_info->compressed_size,
+                    file_info->modified_date, file_info->crc, file_info->compression_method, file_info->flag,
+                    mz_zip_entry_is_dir(zip_handle) == MZ_OK ? ZIP_INDEX_ATTR_DIR : 0, file_info->comment,
+                    file_info->comment ? file_info->comment_size : 0);
+        err = mz_zip_goto_next_entry(zip_handle);
+    }
+
+    return err == MZ_END_OF_LIST ? MZ_OK : err;
+}
+
+int32_t ZipEntryIndex::layout(const ZipIndexBuilder& builder) {
+    ZipIndexHeader h = builder.h;
+    const std::string& pool = builder.pool;
+    const std::vector<uint64_t>& entry_name_off = builder.name_off;
+
+    size_t n = builder.cd_pos.size();
+    // Entry indexes are stored in 32 bits
+    if (n >= UINT32_MAX) {
+        return MZ_MEM_ERROR;
+    }
+
+    // Keep the load factor at or below 1/2
+    uint64_t bucket_count = 16;
+    while (bucket_count < (uint64_t)n * 2) {
+        bucket_count <<= 1;
+    }
+    uint64_t mask = bucket_count - 1;
+
+    std::vector<uint32_t> table(bucket_count, 0);
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const char* name = pool.c_str() + entry_name_off[i];
+        uint64_t b = hash_name(name) & mask;
+        while (table[b] && strcmp(pool.c_str() + entry_name_off[table[b] - 1], name)) {
+            b = (b + 1) & mask;
+        }
+        // Keep the first occurrence of duplicate names, as a linear directory scan would find it first
+        if (!table[b]) {
+            table[b] = (uint32_t)i + 1;
+            order.push_back((uint32_t)i);
+        }
+    }
+
+    const char* pool_ptr = pool.c_str();
+    std::sort(order.begin(), order.end(), [pool_ptr, &entry_name_off] (uint32_t a, uint32_t b) {
+        return strcmp(pool_ptr + entry_name_off[a], pool_ptr + entry_name_off[b]) < 0;
+    });
+
+    std::vector<uint64_t> name_off_end(entry_name_off);
+    name_off_end.push_back(pool.size());
+
+    std::vector<int64> method_pairs;
+    for (const method_count_map_t::value_type& i : builder.method_counts) {
+        method_pairs.push_back(i.first);
+        method_pairs.push_back(i.second);
+    }
+
+    memcpy(h.magic, ZIP_INDEX_MAGIC, sizeof(h.magic));
+    h.version = ZIP_INDEX_VERSION;
+    h.byte_order = ZIP_INDEX_BYTE_ORDER;
+    h.entry_count = n;
+    h.unique_count = order.size();
+    h.bucket_count = bucket_count;
+    h.method_count = builder.method_counts.size();
+    h.comment_count = builder.comments.size() / 2;
+    h.names_size = pool.size();
+
+    uint64_t pos = align8(sizeof(ZipIndexHeader));
+    h.cd_pos_offset = place_section<int64>(pos, n);
+    h.name_off_offset = place_section<uint64_t>(pos, n + 1);
+    h.local_offset_offset = place_section<int64>(pos, n);
+    h.uncompressed_size_offset = place_section<int64>(pos, n);
+    h.compressed_size_offset = place_section<int64>(pos, n);
+    h.modified_offset = place_section<int64>(pos, n);
+    h.crc_offset = place_section<uint32_t>(pos, n);
+    h.method_offset = place_section<uint16_t>(pos, n);
+    h.flag_offset = place_section<uint16_t>(pos, n);
+    h.attr_offset = place_section<uint8_t>(pos, n);
+    h.buckets_offset = place_section<uint32_t>(pos, bucket_count);
+    h.sorted_offset = place_section<uint32_t>(pos, order.size());
+    h.methods_offset = place_section<int64>(pos, method_pairs.size());
+    h.comments_offset = place_section<uint64_t>(pos, builder.comments.size());
+    h.names_offset = place_section<char>(pos, pool.size());
+    h.block_size = pos;
+
+    data.assign(h.block_size / sizeof(uint64_t), 0);
+    char* block = (char*)&data[0];
+    memcpy(block, &h, sizeof(h));
+    copy_section(block, h.cd_pos_offset, builder.cd_pos);
+    copy_section(block, h.name_off_offset, name_off_end);
+    copy_section(block, h.local_offset_offset, builder.local_offset);
+    copy_section(block, h.uncompressed_size_offset, builder.uncompressed_size);
+    copy_section(block, h.compressed_size_offset, builder.compressed_size);
+    copy_section(block, h.modified_offset, builder.modified);
+    copy_section(block, h.crc_offset, builder.crc);
+    copy_section(block, h.method_offset, builder.method);
+    copy_section(block, h.flag_offset, builder.flag);
+    copy_section(block, h.attr_offset, builder.attr);
+    copy_section(block, h.buckets_offset, table);
+    copy_section(block, h.sorted_offset, order);
+    copy_section(block, h.methods_offset, method_pairs);
+    copy_section(block, h.comments_offset, builder.comments);
+    memcpy(block + h.names_offset, pool.data(), pool.size());
+
+    if (attach(block, h.block_size)) {
+        clear();
+        return MZ_INTERNAL_ERROR;
+    }
+    return MZ_OK;
+}
+
+int ZipEntryIndex::attach(const char* block, size_t size) {
+    if (size < sizeof(ZipIndexHeader)) {
+        return -1;
+    }
+
+    const ZipIndexHeader* h = (const ZipIndexHeader*)block;
+    uint64_t n = h->entry_count;
+    if (memcmp(h->magic, ZIP_INDEX_MAGIC, sizeof(h->magic)) || h->version != ZIP_INDEX_VERSION
+        || h->byte_order != ZIP_INDEX_BYTE_ORDER || h->block_size != size
+        || n >= UINT32_MAX || h->unique_count > n
+        || !h->bucket_count || (h->bucket_count & (h->bucket_count - 1)) || h->bucket_count <= h->unique_count
+        || !check_section(h->cd_pos_offset, n, sizeof(int64), size)
+        || !check_section(h->name_off_offset, n + 1, sizeof(uint64_t), size)
+        || !check_section(h->local_offset_offset, n, sizeof(int64), size)
+        || !check_section(h->uncompressed_size_offset, n, sizeof(int64), size)
+        || !check_section(h->compressed_size_offset, n, sizeof(int64), size)
+        || !check_section(h->modified_offset, n, sizeof(int64), size)
+        || !check_section(h->crc_offset, n, sizeof(uint32_t), size)
+        || !check_section(h->method_offset, n, sizeof(uint16_t), size)
+        || !check_section(h->flag_offset, n, sizeof(uint16_t), size)
+        || !check_section(h->attr_offset, n, sizeof(uint8_t), size)
+        || !check_section(h->buckets_offset, h->bucket_count, sizeof(uint32_t), size)
+        || !check_section(h->sorted_offset, h->unique_count, sizeof(uint32_t), size)
+        || !check_section(h->methods_offset, h->method_count, 2 * sizeof(int64), size)
+        || !check_section(h->comments_offset, h->comment_count, 2 * sizeof(uint64_t), size)
+        || !check_section(h->names_offset, h->names_size, 1, size)) {
+        return -1;
+    }
+
+    // Names must be terminated so that corrupted offsets cannot lead to reads beyond the pool
+    if (n && (!h->names_size || block[h->names_offset + h->names_size - 1])) {
+        return -1;
+    }
+
+    hdr = h;
+    cd_pos = (const int64*)(block + h->cd_pos_offset);
+    name_off = (const uint64_t*)(block + h->name_off_offset);
+    local_offset = (const int64*)(block + h->local_offset_offset);
+    uncompressed_size = (const int64*)(block + h->uncompressed_size_offset);
+    compressed_size = (const int64*)(block + h->compressed_size_offset);
+    modified = (const int64*)(block + h->modified_offset);
+    crc = (const uint32_t*)(block + h->crc_offset);
+    method = (const uint16_t*)(block + h->method_offset);
+    flag = (const uint16_t*)(block + h->flag_offset);
+    attr = (const uint8_t*)(block + h->attr_offset);
+    buckets = (const uint32_t*)(block + h->buckets_offset);
+    sorted = (const uint32_t*)(block + h->sorted_offset);
+    methods = (const int64*)(block + h->methods_offset);
+    comments = (const uint64_t*)(block + h->comments_offset);
+    names = block + h->names_offset;
+    return 0;
+}
+
+int ZipEntryIndex::save(const char* path, const ZipIndexKey& key) const {
+    if (!hdr) {
+        return -1;
+    }
+
+    // Every writer gets a temporary file of its own in the target directory, so a file that has already been
+    // renamed into place is never truncated or rewritten by another writer
+    std::string tmp_path(path);
+    tmp_path += ".tmpXXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0) {
+        return -1;
+    }
+    // mkstemp() creates the file readable by the owner only
+    fchmod(fd, 0644);
+
+    ZipIndexHeader h = *hdr;
+    h.key = key;
+    const char* block = (const char*)hdr;
+    int rc = write_all(fd, (const char*)&h, sizeof(h));
+    if (!rc) {
+        rc = write_all(fd, block + sizeof(h), hdr->block_size - sizeof(h));
+    }
+    if (::close(fd)) {
+        rc = -1;
+    }
+    if (!rc && rename(tmp_path.c_str(), path)) {
+        rc = -1;
+    }
+    if (rc) {
+        unlink(tmp_path.c_str());
+    }
+    return rc;
+}
+
+bool ZipEntryIndex::load(const char* path, const ZipIndexKey& key) {
+    clear();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(ZipIndexHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        return false;
+    }
+    mapping = m;
+    mapping_size = st.st_size;
+
+    if (attach((const char*)m, mapping_size) || !(hdr->key == key)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void ZipEntryIndex::clear() {
+    hdr = nullptr;
+    cd_pos = nullptr;
+    name_off = nullptr;
+    local_offset = nullptr;
+    uncompressed_size = nullptr;
+    compressed_size = nullptr;
+    modified = nullptr;
+    crc = nullptr;
+    method = nullptr;
+    flag = nullptr;
+    attr = nullptr;
+    buckets = nullptr;
+    sorted = nullptr;
+    methods = nullptr;
+    comments = nullptr;
+    names = nullptr;
+    data.clear();
+    if (mapping) {
+        munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+}
+
+const char* ZipEntryIndex::getName(size_t i) const {
+    uint64_t offset = name_off[i];
+    return offset < hdr->names_size ? names + offset : "";
+}
+
+size_t ZipEntryIndex::getSortedIndex(size_t i) const {
+    uint32_t v = sorted[i];
+    return v < hdr->entry_count ? v : 0;
+}
+
+bool ZipEntryIndex::getComment(size_t i, const char*& comment, size_t& len) const {
+    // Binary search in the comment table, which is in entry order
+    size_t lo = 0, hi = hdr->comment_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint64_t entry = comments[mid * 2] >> 32;
+        if (entry < i) {
+            lo = mid + 1;
+        } else if (entry > i) {
+            hi = mid;
+        } else {
+            uint64_t offset = comments[mid * 2 + 1];
+            len = comments[mid * 2] & 0xffffffff;
+            if (offset > hdr->names_size || len > hdr->names_size - offset) {
+                return false;
+            }
+            comment = names + offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+int64 ZipEntryIndex::find(const char* name) const {
+    if (!hdr) {
+        return -1;
+    }
+
+    uint64_t mask = hdr->bucket_count - 1;
+    uint64_t b = hash_name(name) & mask;
+    for (uint64_t probes = 0; probes < hdr->bucket_count; ++probes, b = (b + 1) & mask) {
+        uint32_t v = buckets[b];
+        if (!v) {
+            break;
+        }
+        if (v <= hdr->entry_count && !strcmp(getName(v - 1), name)) {
+            return v - 1;
+        }
+    }
+    return -1;
+}
+
+int64 ZipEntryIndex::getDataOffset(const ZipArchiveData& data, size_t i) const {
+    std::vector<uint8_t> buf;
+    int64 offset = local_offset[i];
+    const uint8_t* rec = data.read(offset, ZIP_LOCAL_HEADER_SIZE, buf);
+    if (!rec || get32(rec) != ZIP_SIG_LOCAL_HEADER) {
+        return -1;
+    }
+    // The local name and extra field lengths can differ from the central directory
+    return offset + ZIP_LOCAL_HEADER_SIZE + get16(rec + 26) + get16(rec + 28);
+}
+
+size_t ZipEntryIndex::size() const {
+    return hdr ? hdr->unique_count : 0;
+}
+
+size_t ZipEntryIndex::lowerBound(const char* name) const {
+    size_t lo = 0, hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(getSortedName(mid), name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int64 ZipEntryIndex::getEntryCount() const {
+    return hdr ? hdr->entry_count : 0;
+}
+
+int64 ZipEntryIndex::getTotalSize() const {
+    return hdr ? hdr->total_size : 0;
+}
+
+int64 ZipEntryIndex::getTotalCompressedSize() const {
+    return hdr ? hdr->total_compressed_size : 0;
+}
+
+int64 ZipEntryIndex::getDirectoryCount() const {
+    return hdr ? hdr->directory_count : 0;
+}
+
+int64 ZipEntryIndex::getEncryptedCount() const {
+    return hdr ? hdr->encrypted_count : 0;
+}
+
+void ZipEntryIndex::getMethodCounts(method_count_map_t& method_counts) const {
+    if (!hdr) {
+        return;
+    }
+    for (uint64_t i = 0; i < hdr->method_count; ++i) {
+        method_counts[(int)methods[i * 2]] += methods[i * 2 + 1];
+    }
+}
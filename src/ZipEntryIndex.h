@@ -0,0 +1,332 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryIndex.h ZipEntryIndex class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPENTRYINDEX_H
+#define _QORE_ZIP_ZIPENTRYINDEX_H
+
+#include "zip-module.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+//! Identifies the state of an archive file that a persistent index was created for
+/** An index file is only used if the size, the modification time and a checksum of the end of the archive
+    (which contains the end of central directory record) still match.
+*/
+struct ZipIndexKey {
+    uint64_t size = 0;
+    int64_t mtime_sec = 0;
+    int64_t mtime_nsec = 0;
+    uint32_t eocd_crc = 0;
+    uint32_t reserved = 0;
+
+    //! Reads the key of the archive file open on the given file descriptor
+    /** @return 0 on success, -1 if the file cannot be read
+    */
+    DLLLOCAL int read(int fd);
+
+    DLLLOCAL bool operator==(const ZipIndexKey& other) const {
+        return size == other.size && mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec
+            && eocd_crc == other.eocd_crc;
+    }
+};
+
+//! Random access to the raw bytes of an archive for the native central directory parser
+class ZipArchiveData {
+public:
+    DLLLOCAL virtual ~ZipArchiveData() {
+    }
+
+    //! Returns the size of the archive in bytes, or -1 on error
+    DLLLOCAL virtual int64 size() const = 0;
+
+    //! Returns a pointer to \a len bytes at the given offset, or nullptr on error
+    /** @param buf storage for the data if it has to be copied; the returned pointer is valid as long as \a buf
+        is not modified
+    */
+    DLLLOCAL virtual const uint8_t* read(int64 offset, size_t len, std::vector<uint8_t>& buf) const = 0;
+};
+
+//! Archive data read from a file with positional reads
+class ZipFileArchiveData : public ZipArchiveData {
+public:
+    //! Reads from the given file descriptor, which is not closed by this object
+    DLLLOCAL ZipFileArchiveData(int fd, int64 size) : fd(fd), file_size(size) {
+    }
+
+    DLLLOCAL virtual int64 size() const override {
+        return file_size;
+    }
+
+    DLLLOCAL virtual const uint8_t* read(int64 offset, size_t len, std::vector<uint8_t>& buf) const override;
+
+private:
+    int fd;
+    int64 file_size;
+};
+
+//! Archive data in memory
+class ZipMemoryArchiveData : public ZipArchiveData {
+public:
+    DLLLOCAL ZipMemoryArchiveData(const void* data, size_t size) : data((const uint8_t*)data), data_size(size) {
+    }
+
+    DLLLOCAL virtual int64 size() const override {
+        return data_size;
+    }
+
+    DLLLOCAL virtual const uint8_t* read(int64 offset, size_t len, std::vector<uint8_t>& buf) const override {
+        return (offset >= 0 && (uint64_t)offset <= data_size && len <= data_size - offset) ? data + offset : nullptr;
+    }
+
+private:
+    const uint8_t* data;
+    size_t data_size;
+};
+
+struct ZipIndexHeader;
+class ZipIndexBuilder;
+
+//! ZipEntryIndex - compact metadata index for the central directory of an archive opened for reading
+/** The index is built once when the archive is opened and holds the metadata of all entries, so that
+    metadata queries and name-based lookups do not have to decode central directory records again.  Entry
+    metadata is kept in packed per-field arrays indexed by the position of the entry in the central directory,
+    with entry names and comments in a string pool.  An open addressing hash table maps names to entries, and
+    the entries are also kept in name order to support prefix range queries.  Archive totals are collected in
+    the same pass.
+
+    The index is normally filled by parsing the raw central directory in a single pass; archives the native
+    parser does not handle (split archives, for example) are indexed by walking the directory with minizip.
+
+    The index is stored in a single position-independent block of memory, so that it can be written to an
+    index file and later memory-mapped instead of being rebuilt; see save() and load().
+
+    @note An index is not modified after it has been built or loaded, so it can be shared between threads and
+    QoreZipFile objects; see ZipIndexCache.
+*/
+class ZipEntryIndex {
+public:
+    DLLLOCAL ZipEntryIndex() {
+    }
+
+    DLLLOCAL ~ZipEntryIndex() {
+        clear();
+    }
+
+    //! Builds the index for the given archive
+    /** @param zip_handle the minizip zip handle of the archive opened for reading
+        @param data the raw data of the archive for the native parser, or nullptr to walk the directory with
+        minizip
+
+        @return MZ_OK on success, otherwise a minizip error code
+    */
+    DLLLOCAL int32_t build(void* zip_handle, const ZipArchiveData* data);
+
+    //! Writes the index to the given file
+    /** The file is written under a temporary name and renamed, so that concurrent readers never see a
+        partially written index.
+
+        @param path the path of the index file
+        @param key the key of the archive the index was built from
+
+        @return 0 on success, -1 on error
+    */
+    DLLLOCAL int save(const char* path, const ZipIndexKey& key) const;
+
+    //! Maps the given index file if it is valid and was created for an archive with the given key
+    /** @return true if the index was loaded, false if the file does not exist, is invalid or is stale
+    */
+    DLLLOCAL bool load(const char* path, const ZipIndexKey& key);
+
+    //! Removes all entries from the index
+    DLLLOCAL void clear();
+
+    //! Returns the central directory order position of the given entry, or -1 if the entry does not exist
+    DLLLOCAL int64 find(const char* name) const;
+
+    //! Returns the offset of the data of the entry at the given position, or -1 if its local header is invalid
+    /** @param data the raw archive data to read the local header of the entry from
+        @param i the position of the entry in central directory order
+    */
+    DLLLOCAL int64 getDataOffset(const ZipArchiveData& data, size_t i) const;
+
+    //! Returns the number of indexed entry names
+    DLLLOCAL size_t size() const;
+
+    //! Returns the number of bytes used by the index
+    DLLLOCAL int64 getMemorySize() const {
+        return data.size() * sizeof(uint64_t) + mapping_size;
+    }
+
+    //! Returns the name order position of the first entry whose name is not less than the given name
+    DLLLOCAL size_t lowerBound(const char* name) const;
+
+    //! Returns the name of the entry at the given position in name order
+    DLLLOCAL const char* getSortedName(size_t i) const {
+        return getName(getSortedIndex(i));
+    }
+
+    //! Returns the central directory order position of the entry at the given position in name order
+    DLLLOCAL size_t getSortedIndex(size_t i) const;
+
+    //! @name Entry metadata
+    //! The entry is identified by its position in the central directory; i must be less than getEntryCount()
+    //@{
+    DLLLOCAL const char* getName(size_t i) const;
+
+    //! Returns the central directory position of the entry as used by mz_zip_goto_entry()
+    DLLLOCAL int64 getCdPos(size_t i) const {
+        return cd_pos[i];
+    }
+
+    //! Returns the offset of the local header of the entry
+    DLLLOCAL int64 getLocalOffset(size_t i) const {
+        return local_offset[i];
+    }
+
+    DLLLOCAL int64 getSize(size_t i) const {
+        return uncompressed_size[i];
+    }
+
+    DLLLOCAL int64 getCompressedSize(size_t i) const {
+        return compressed_size[i];
+    }
+
+    //! Returns the modification time as seconds since the epoch
+    DLLLOCAL int64 getModified(size_t i) const {
+        return modified[i];
+    }
+
+    DLLLOCAL uint32_t getCrc(size_t i) const {
+        return crc[i];
+    }
+
+    DLLLOCAL int getMethod(size_t i) const {
+        return method[i];
+    }
+
+    DLLLOCAL bool isEncrypted(size_t i) const {
+        return flag[i] & MZ_ZIP_FLAG_ENCRYPTED;
+    }
+
+    //! Returns true if the entry is a directory according to its attributes or name
+    DLLLOCAL bool isDirectory(size_t i) const {
+        return attr[i] & ZIP_INDEX_ATTR_DIR;
+    }
+
+    //! Gets the comment of the entry; returns false if the entry has no comment
+    DLLLOCAL bool getComment(size_t i, const char*& comment, size_t& len) const;
+    //@}
+
+    //! Returns the number of entries in the central directory (including duplicate names)
+    DLLLOCAL int64 getEntryCount() const;
+
+    //! Returns the sum of the uncompressed sizes of all entries
+    DLLLOCAL int64 getTotalSize() const;
+
+    //! Returns the sum of the compressed sizes of all entries
+    DLLLOCAL int64 getTotalCompressedSize() const;
+
+    //! Returns the number of directory entries
+    DLLLOCAL int64 getDirectoryCount() const;
+
+    //! Returns the number of encrypted entries
+    DLLLOCAL int64 getEncryptedCount() const;
+
+    //! Maps compression methods to the number of entries using them
+    typedef std::map<int, int64> method_count_map_t;
+
+    //! Returns the number of entries per compression method
+    DLLLOCAL void getMethodCounts(method_count_map_t& method_counts) const;
+
+    //! attribute flag for directory entries
+    static const uint8_t ZIP_INDEX_ATTR_DIR = 1;
+
+private:
+    //! header of the index block, or nullptr if the index is empty
+    const ZipIndexHeader* hdr = nullptr;
+
+    //! @name Per-entry arrays in central directory order
+    //@{
+    const int64* cd_pos = nullptr;
+    //! offsets of the NUL-terminated entry names in the string pool
+    const uint64_t* name_off = nullptr;
+    const int64* local_offset = nullptr;
+    const int64* uncompressed_size = nullptr;
+    const int64* compressed_size = nullptr;
+    const int64* modified = nullptr;
+    const uint32_t* crc = nullptr;
+    const uint16_t* method = nullptr;
+    const uint16_t* flag = nullptr;
+    const uint8_t* attr = nullptr;
+    //@}
+
+    //! open addressing hash table; entry index + 1 or 0 for empty buckets
+    const uint32_t* buckets = nullptr;
+    //! entry indexes in name order; only the first occurrence of duplicate names is included
+    const uint32_t* sorted = nullptr;
+    //! compression method / entry count pairs
+    const int64* methods = nullptr;
+    //! (entry index << 32 | comment length) / string pool offset pairs for entries with comments, in entry order
+    const uint64_t* comments = nullptr;
+    //! string pool
+    const char* names = nullptr;
+
+    //! storage for an index built in memory
+    std::vector<uint64_t> data;
+    //! storage for an index mapped from a file
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    DLLLOCAL ZipEntryIndex(const ZipEntryIndex&) = delete;
+    DLLLOCAL ZipEntryIndex& operator=(const ZipEntryIndex&) = delete;
+
+    //! Fills the builder by parsing the raw central directory
+    /** @param cd_pos_base the central directory position of the first entry as reported by minizip
+        @param first_name the name of the first entry as reported by minizip
+
+        @return 0 on success, -1 if the archive cannot be handled by the native parser
+    */
+    DLLLOCAL static int parse(const ZipArchiveData& data, int64 cd_pos_base, const char* first_name,
+                              ZipIndexBuilder& builder);
+
+    //! Fills the builder by walking the central directory with minizip
+    DLLLOCAL static int32_t walk(void* zip_handle, ZipIndexBuilder& builder);
+
+    //! Creates the index block from the collected entry data
+    DLLLOCAL int32_t layout(const ZipIndexBuilder& builder);
+
+    //! Validates the given index block and sets up the section pointers
+    /** Only the header and the section bounds are checked here; per-entry values are checked when they are
+        accessed, so that mapping an index file does not have to touch all of its pages.
+
+        @return 0 if the block is valid, -1 if not
+    */
+    DLLLOCAL int attach(const char* block, size_t size);
+};
+
+#endif // _QORE_ZIP_ZIPENTRYINDEX_H
@@ -0,0 +1,78 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryIterator.cpp ZipEntryIterator class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipEntryIterator.h"
+#include "QoreZipFile.h"
+#include "QC_ZipFile.h"
+
+QoreZipEntryIterator::QoreZipEntryIterator(QoreZipFile* z) : zf(z), pos(-1), entry(nullptr) {
+    zf->ref();
+}
+
+QoreZipEntryIterator::~QoreZipEntryIterator() {
+}
+
+void QoreZipEntryIterator::deref(ExceptionSink* xsink) {
+    if (ROdereference()) {
+        if (entry) {
+            entry->deref(xsink);
+        }
+        zf->deref(xsink);
+        delete this;
+    }
+}
+
+bool QoreZipEntryIterator::next(ExceptionSink* xsink) {
+    if (entry) {
+        entry->deref(xsink);
+        entry = nullptr;
+    } else if (pos >= 0) {
+        // The end of the directory has already been reached
+        return false;
+    }
+
+    entry = zf->nextEntry(pos, xsink);
+    return entry != nullptr;
+}
+
+QoreObject* QoreZipEntryIterator::getValue(ExceptionSink* xsink) const {
+    if (!entry) {
+        xsink->raiseException("ITERATOR-ERROR", "the ZipEntryIterator is not pointing at a valid element; make "
+                              "sure ZipEntryIterator::next() returns True before calling this method");
+        return nullptr;
+    }
+
+    entry->ref();
+    return new QoreObject(QC_ZIPENTRY, getProgram(), entry);
+}
+
+void QoreZipEntryIterator::reset(ExceptionSink* xsink) {
+    if (entry) {
+        entry->deref(xsink);
+        entry = nullptr;
+    }
+    pos = -1;
+}
@@ -0,0 +1,76 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipEntryIterator.h ZipEntryIterator class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPENTRYITERATOR_H
+#define _QORE_ZIP_ZIPENTRYITERATOR_H
+
+#include "zip-module.h"
+
+// Forward declarations
+class QoreZipFile;
+class QoreZipEntry;
+
+//! QoreZipEntryIterator - private data class for the ZipEntryIterator Qore class
+/** Walks the entry index of an archive one entry at a time; only the current entry is held in memory.  The
+    iterator stores the central directory order position of the current entry, so it is not affected by other
+    operations on the archive between calls.
+
+    @note This class is not thread-safe. Only one thread should access an instance at a time.
+*/
+class QoreZipEntryIterator : public AbstractPrivateData {
+public:
+    //! Constructor
+    /** @param zf the archive to iterate; a reference is held for the lifetime of the iterator
+    */
+    DLLLOCAL QoreZipEntryIterator(QoreZipFile* zf);
+
+    //! Moves to the next entry; returns false if there are no more entries
+    DLLLOCAL bool next(ExceptionSink* xsink);
+
+    //! Returns a new ZipEntry object for the current entry
+    DLLLOCAL QoreObject* getValue(ExceptionSink* xsink) const;
+
+    //! Returns true if the iterator is positioned on an entry
+    DLLLOCAL bool valid() const {
+        return entry != nullptr;
+    }
+
+    //! Resets the iterator to the position before the first entry
+    DLLLOCAL void reset(ExceptionSink* xsink);
+
+    //! Releases the archive and the current entry when the last reference is removed
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) override;
+
+protected:
+    DLLLOCAL virtual ~QoreZipEntryIterator();
+
+private:
+    QoreZipFile* zf;            //!< the archive being iterated
+    int64 pos;                  //!< central directory order position of the current entry, -1 before the first entry
+    QoreZipEntry* entry;        //!< the current entry, nullptr if not positioned on an entry
+};
+
+#endif // _QORE_ZIP_ZIPENTRYITERATOR_H
@@ -0,0 +1,191 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipExtractor.cpp ZipExtractor class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipExtractor.h"
+#include "ZipThreadPool.h"
+
+#include <mz_os.h>
+
+#include <atomic>
+#include <mutex>
+
+// The first error of a parallel extraction
+struct ZipExtractFailure {
+    std::mutex m;
+    std::atomic<bool> failed;
+    int32_t error_code = MZ_OK;
+    std::string error_path;         //!< empty if no reader could be opened
+
+    ZipExtractFailure() : failed(false) {
+    }
+
+    //! Records the error; returns false if an error has already been recorded
+    bool set(int32_t err, const std::string& path) {
+        std::lock_guard<std::mutex> lock(m);
+        if (failed) {
+            return false;
+        }
+        error_code = err;
+        error_path = path;
+        failed = true;
+        return true;
+    }
+};
+
+int ZipExtractor::extractAll(ZipReaderPool& readers, const ZipExtractPlan& plan, QoreString& error) {
+    const char* entry_password = plan.has_password ? plan.password.c_str() : nullptr;
+
+    if (plan.threads > 1) {
+        ZipExtractFailure failure;
+        ZipTaskGroup group(plan.threads, plan.queue_depth ? plan.queue_depth : plan.threads * 2);
+        for (const ZipExtractTask& task : plan.tasks) {
+            if (failure.failed) {
+                break;
+            }
+            const ZipExtractTask* t = &task;
+            group.add([&readers, &group, &failure, t, entry_password] () {
+                if (failure.failed) {
+                    return;
+                }
+                int32_t err = MZ_OK;
+                void* reader = readers.acquire(err);
+                if (!reader) {
+                    if (failure.set(err, std::string())) {
+                        group.cancel();
+                    }
+                    return;
+                }
+                err = extract(ZipReaderPool::getZipHandle(reader), *t, entry_password);
+                readers.release(reader);
+                if (err != MZ_OK && failure.set(err, t->path)) {
+                    group.cancel();
+                }
+            });
+        }
+        group.wait();
+
+        if (failure.failed) {
+            if (failure.error_path.empty()) {
+                error.sprintf("failed to open ZIP archive for extraction: error %d", failure.error_code);
+            } else {
+                error.sprintf("failed to extract '%s': error %d", failure.error_path.c_str(), failure.error_code);
+            }
+            return -1;
+        }
+        return 0;
+    }
+
+    int32_t err = MZ_OK;
+    void* reader = readers.acquire(err);
+    if (!reader) {
+        error.sprintf("failed to open ZIP archive for extraction: error %d", err);
+        return -1;
+    }
+    void* zip_handle = ZipReaderPool::getZipHandle(reader);
+    int rc = 0;
+    for (const ZipExtractTask& task : plan.tasks) {
+        err = extract(zip_handle, task, entry_password);
+        if (err != MZ_OK) {
+            error.sprintf("failed to extract '%s': error %d", task.path.c_str(), err);
+            rc = -1;
+            break;
+        }
+    }
+    readers.release(reader);
+    return rc;
+}
+
+int32_t ZipExtractor::extract(void* zip_handle, const ZipExtractTask& task, const char* entry_password) {
+    mz_zip_file* file_info = nullptr;
+    int32_t err = mz_zip_goto_entry(zip_handle, task.cd_pos);
+    if (err == MZ_OK) {
+        err = mz_zip_entry_get_info(zip_handle, &file_info);
+    }
+    if (err == MZ_OK) {
+        err = saveEntry(zip_handle, file_info, task.path.c_str(), entry_password);
+    }
+    return err;
+}
+
+int32_t ZipExtractor::saveEntry(void* zip_handle, mz_zip_file* file_info, const char* dest_path,
+                                const char* entry_password) {
+    if (mz_zip_entry_is_dir(zip_handle) == MZ_OK) {
+        return mz_dir_make(dest_path);
+    }
+
+    // Create the parent directory if necessary
+    std::string parent_dir(dest_path);
+    size_t pos = parent_dir.rfind('/');
+    if (pos != std::string::npos && pos > 0) {
+        parent_dir.resize(pos);
+        int32_t err = mz_dir_make(parent_dir.c_str());
+        if (err != MZ_OK) {
+            return err;
+        }
+    }
+
+    int32_t err = mz_zip_entry_read_open(zip_handle, 0, entry_password);
+    if (err != MZ_OK) {
+        return err;
+    }
+
+    void* out = mz_stream_os_create();
+    err = mz_stream_os_open(out, dest_path, MZ_OPEN_MODE_CREATE | MZ_OPEN_MODE_WRITE);
+    if (err == MZ_OK) {
+        std::vector<char> buf(ZIP_COPY_BUF_SIZE);
+        while (true) {
+            int32_t bytes_read = mz_zip_entry_read(zip_handle, &buf[0], (int32_t)buf.size());
+            if (bytes_read <= 0) {
+                err = bytes_read;
+                break;
+            }
+            if (mz_stream_os_write(out, &buf[0], bytes_read) != bytes_read) {
+                err = MZ_WRITE_ERROR;
+                break;
+            }
+        }
+        mz_stream_os_close(out);
+    }
+    mz_stream_os_delete(&out);
+
+    // Closing the entry verifies the CRC once all data has been read
+    int32_t close_err = mz_zip_entry_close(zip_handle);
+    if (err == MZ_OK) {
+        err = close_err;
+    }
+    if (err == MZ_OK) {
+        mz_os_set_file_date(dest_path, file_info->modified_date, file_info->accessed_date,
+                            file_info->creation_date);
+
+        uint32_t target_attrib = 0;
+        if (mz_zip_attrib_convert(MZ_HOST_SYSTEM(file_info->version_madeby), file_info->external_fa,
+                                  MZ_VERSION_MADEBY_HOST_SYSTEM, &target_attrib) == MZ_OK) {
+            mz_os_set_file_attribs(dest_path, target_attrib);
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,88 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipExtractor.h ZipExtractor class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPEXTRACTOR_H
+#define _QORE_ZIP_ZIPEXTRACTOR_H
+
+#include "zip-module.h"
+#include "ZipReaderPool.h"
+
+#include <string>
+#include <vector>
+
+//! Size of the buffer used to copy entry data to files (64KB)
+#define ZIP_COPY_BUF_SIZE (64 * 1024)
+
+//! An entry to be extracted by a ZipExtractor
+struct ZipExtractTask {
+    int64 cd_pos;           //!< central directory position of the entry
+    std::string path;       //!< destination file path
+};
+
+//! The entries to extract and the settings for extracting them
+struct ZipExtractPlan {
+    std::vector<ZipExtractTask> tasks;  //!< the entries to extract in extraction order
+    std::string password;               //!< the password for encrypted entries
+    bool has_password = false;          //!< true if \c password is set
+    unsigned threads = 1;               //!< the number of threads including the calling thread; 1 extracts in the calling thread
+    size_t queue_depth = 0;             //!< the maximum number of queued entries; 0 for twice the number of threads
+};
+
+//! ZipExtractor - extracts entries of an archive to files
+/** With more than one thread, each entry is queued as a task of a ZipTaskGroup in the module thread pool; the
+    calling thread and the pool threads running the tasks check out a reader handle from the archive's
+    ZipReaderPool for each entry.  The first error discards the remaining tasks.  Extraction does not use the
+    Qore API.
+
+    The archive must stay open (its read lock held) until extractAll() has returned.
+*/
+class ZipExtractor {
+public:
+    //! Extracts the entries of the given plan
+    /** Does not use the Qore API, so it can also be called in background threads
+
+        @return 0 on success, -1 if an error occurred (\a error is set)
+    */
+    DLLLOCAL static int extractAll(ZipReaderPool& readers, const ZipExtractPlan& plan, QoreString& error);
+
+    //! Extracts the entry of the given task with the given mz_zip handle
+    /** @return MZ_OK on success, otherwise a minizip error code
+    */
+    DLLLOCAL static int32_t extract(void* zip_handle, const ZipExtractTask& task, const char* entry_password);
+
+    //! Writes the entry the given mz_zip handle is positioned on to a file
+    /** Creates the parent directory of the file if necessary; directory entries are created as directories.
+        The modification time and, if they can be converted to the host system, the file attributes of the
+        entry are applied to the file.  Symbolic link entries are written as regular files containing the link
+        target, so that extraction cannot create links pointing outside of the destination directory.
+
+        @return MZ_OK on success, otherwise a minizip error code
+    */
+    DLLLOCAL static int32_t saveEntry(void* zip_handle, mz_zip_file* file_info, const char* dest_path,
+                                      const char* entry_password);
+};
+
+#endif // _QORE_ZIP_ZIPEXTRACTOR_H
@@ -0,0 +1,133 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipIndexCache.cpp ZipIndexCache class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipIndexCache.h"
+
+#include <sys/stat.h>
+
+ZipIndexCache zip_index_cache;
+
+int ZipIndexCacheKey::read(int fd) {
+    struct stat st;
+    if (fstat(fd, &st)) {
+        return -1;
+    }
+
+    dev = st.st_dev;
+    ino = st.st_ino;
+    size = st.st_size;
+    mtime_sec = st.st_mtime;
+#ifdef __APPLE__
+    mtime_nsec = st.st_mtimespec.tv_nsec;
+#else
+    mtime_nsec = st.st_mtim.tv_nsec;
+#endif
+    return 0;
+}
+
+bool ZipIndexCacheKey::operator<(const ZipIndexCacheKey& other) const {
+    if (dev != other.dev) {
+        return dev < other.dev;
+    }
+    if (ino != other.ino) {
+        return ino < other.ino;
+    }
+    if (size != other.size) {
+        return size < other.size;
+    }
+    if (mtime_sec != other.mtime_sec) {
+        return mtime_sec < other.mtime_sec;
+    }
+    return mtime_nsec < other.mtime_nsec;
+}
+
+std::shared_ptr<const ZipEntryIndex> ZipIndexCache::get(const ZipIndexCacheKey& key) {
+    AutoLocker al(l);
+
+    key_map_t::iterator i = key_map.find(key);
+    if (i == key_map.end()) {
+        ++stats.misses;
+        return std::shared_ptr<const ZipEntryIndex>();
+    }
+
+    ++stats.hits;
+    lru.splice(lru.begin(), lru, i->second);
+    return i->second->second;
+}
+
+void ZipIndexCache::put(const ZipIndexCacheKey& key, const std::shared_ptr<const ZipEntryIndex>& index) {
+    AutoLocker al(l);
+
+    int64 index_size = index->getMemorySize();
+    if (index_size > stats.max_size) {
+        return;
+    }
+
+    // Another object may have indexed the same archive in the meantime
+    key_map_t::iterator i = key_map.find(key);
+    if (i != key_map.end()) {
+        stats.size -= i->second->second->getMemorySize();
+        lru.erase(i->second);
+        key_map.erase(i);
+    }
+
+    lru.push_front(lru_entry_t(key, index));
+    key_map[key] = lru.begin();
+    stats.size += index_size;
+    evictUnlocked();
+}
+
+void ZipIndexCache::setMaxSize(int64 max_size) {
+    AutoLocker al(l);
+
+    stats.max_size = max_size > 0 ? max_size : 0;
+    evictUnlocked();
+}
+
+void ZipIndexCache::clear() {
+    AutoLocker al(l);
+
+    lru.clear();
+    key_map.clear();
+    stats.size = 0;
+}
+
+void ZipIndexCache::getStats(ZipIndexCacheStats& s) {
+    AutoLocker al(l);
+
+    s = stats;
+    s.entries = key_map.size();
+}
+
+void ZipIndexCache::evictUnlocked() {
+    while (stats.size > stats.max_size && !lru.empty()) {
+        lru_entry_t& e = lru.back();
+        stats.size -= e.second->getMemorySize();
+        key_map.erase(e.first);
+        lru.pop_back();
+        ++stats.evictions;
+    }
+}
@@ -0,0 +1,116 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipIndexCache.h ZipIndexCache class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPINDEXCACHE_H
+#define _QORE_ZIP_ZIPINDEXCACHE_H
+
+#include "zip-module.h"
+#include "ZipEntryIndex.h"
+
+#include <list>
+#include <map>
+#include <memory>
+
+//! Default maximum total size of the cached entry indexes (64MB)
+#define ZIP_INDEX_CACHE_DEFAULT_SIZE (64LL * 1024 * 1024)
+
+//! Identifies a version of an archive file in the index cache
+struct ZipIndexCacheKey {
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    uint64_t size = 0;
+    int64_t mtime_sec = 0;
+    int64_t mtime_nsec = 0;
+
+    //! Reads the key of the archive file open on the given file descriptor
+    /** @return 0 on success, -1 if the file cannot be accessed
+    */
+    DLLLOCAL int read(int fd);
+
+    DLLLOCAL bool operator<(const ZipIndexCacheKey& other) const;
+};
+
+//! Counters and size of the index cache
+struct ZipIndexCacheStats {
+    int64 size = 0;
+    int64 max_size = 0;
+    int64 entries = 0;
+    int64 hits = 0;
+    int64 misses = 0;
+    int64 evictions = 0;
+};
+
+//! ZipIndexCache - process-wide cache of entry indexes of archives opened for reading
+/** Entry indexes are immutable once built, so all QoreZipFile objects opened for the same version of an archive
+    file share one index, regardless of the thread or Qore program that opened them.  The least recently used
+    indexes are evicted when the total size exceeds the maximum size; evicted indexes stay valid for the
+    objects still using them.
+
+    This class is thread-safe.
+*/
+class ZipIndexCache {
+public:
+    DLLLOCAL ZipIndexCache() {
+        stats.max_size = ZIP_INDEX_CACHE_DEFAULT_SIZE;
+    }
+
+    //! Returns the cached index for the given key or an empty pointer if not cached
+    DLLLOCAL std::shared_ptr<const ZipEntryIndex> get(const ZipIndexCacheKey& key);
+
+    //! Adds the given index to the cache
+    DLLLOCAL void put(const ZipIndexCacheKey& key, const std::shared_ptr<const ZipEntryIndex>& index);
+
+    //! Sets the maximum total size of cached indexes in bytes; 0 disables the cache
+    DLLLOCAL void setMaxSize(int64 max_size);
+
+    //! Removes all indexes from the cache
+    DLLLOCAL void clear();
+
+    //! Returns the current size and counters of the cache
+    DLLLOCAL void getStats(ZipIndexCacheStats& stats);
+
+private:
+    typedef std::pair<ZipIndexCacheKey, std::shared_ptr<const ZipEntryIndex>> lru_entry_t;
+    //! cached indexes, most recently used first
+    typedef std::list<lru_entry_t> lru_list_t;
+    typedef std::map<ZipIndexCacheKey, lru_list_t::iterator> key_map_t;
+
+    QoreThreadLock l;
+    lru_list_t lru;
+    key_map_t key_map;
+    ZipIndexCacheStats stats;
+
+    DLLLOCAL ZipIndexCache(const ZipIndexCache&) = delete;
+    DLLLOCAL ZipIndexCache& operator=(const ZipIndexCache&) = delete;
+
+    //! Evicts the least recently used indexes until the cache fits in the maximum size (must be called with the lock held)
+    DLLLOCAL void evictUnlocked();
+};
+
+//! The process-wide index cache
+DLLLOCAL extern ZipIndexCache zip_index_cache;
+
+#endif // _QORE_ZIP_ZIPINDEXCACHE_H
@@ -27,10 +27,12 @@
 #include "ZipInputStream.h"
 #include "QoreZipFile.h"
 
-ZipInputStream::ZipInputStream(QoreZipFile* p, void* r, const std::string& name, ExceptionSink* xsink)
-    : parent(p), reader(r), entry_name(name), entry_open(false), eof(false), peek_byte(-2) {
+ZipInputStream::ZipInputStream(QoreZipFile* p, void* r, const std::string& name, const char* password,
+                               ExceptionSink* xsink)
+    : parent(p), reader(r), zip_handle(ZipReaderPool::getZipHandle(r)), entry_name(name), entry_open(false),
+      eof(false), peek_byte(-2) {
     // Open the entry for reading
-    int32_t err = mz_zip_reader_entry_open(reader);
+    int32_t err = mz_zip_entry_read_open(zip_handle, 0, password);
     if (err != MZ_OK) {
         xsink->raiseException("ZIP-STREAM-ERROR", "failed to open entry '%s' for streaming: error %d",
                               entry_name.c_str(), err);
@@ -41,11 +43,12 @@ ZipInputStream::ZipInputStream(QoreZipFile* p, void* r, const std::string& name,
 
 ZipInputStream::~ZipInputStream() {
     if (entry_open) {
-        mz_zip_reader_entry_close(reader);
+        mz_zip_entry_close(zip_handle);
         entry_open = false;
     }
-    // Decrement the parent's active stream count
+    // Return the reader handle and decrement the parent's active stream count
     if (parent) {
+        parent->releaseReader(reader);
         parent->derefStream();
     }
 }
@@ -76,7 +79,7 @@ int64 ZipInputStream::read(void* ptr, int64 limit, ExceptionSink* xsink) {
     }
 
     // Read from the entry
-    int32_t bytes_read = mz_zip_reader_entry_read(reader, buf, static_cast<int32_t>(limit));
+    int32_t bytes_read = mz_zip_entry_read(zip_handle, buf, static_cast<int32_t>(limit));
     if (bytes_read < 0) {
         xsink->raiseException("ZIP-STREAM-ERROR", "error reading entry '%s': error %d",
                               entry_name.c_str(), bytes_read);
@@ -107,7 +110,7 @@ int64 ZipInputStream::peek(ExceptionSink* xsink) {
 
     // Read one byte and buffer it
     uint8_t byte;
-    int32_t bytes_read = mz_zip_reader_entry_read(reader, &byte, 1);
+    int32_t bytes_read = mz_zip_entry_read(zip_handle, &byte, 1);
     if (bytes_read < 0) {
         xsink->raiseException("ZIP-STREAM-ERROR", "error peeking entry '%s': error %d",
                               entry_name.c_str(), bytes_read);
@@ -43,11 +43,14 @@ class ZipInputStream : public InputStream {
 public:
     //! Constructor - opens entry for reading
     /** @param parent the parent ZipFile object
-        @param reader the minizip reader handle (must have entry located)
+        @param reader the mz_zip_reader handle checked out from the parent's reader pool (must be positioned on
+        the entry); returned to the pool when the stream is destroyed
         @param entry_name the name of the entry being read
+        @param password the password for encrypted entries, or nullptr
         @param xsink exception sink
     */
-    DLLLOCAL ZipInputStream(QoreZipFile* parent, void* reader, const std::string& entry_name, ExceptionSink* xsink);
+    DLLLOCAL ZipInputStream(QoreZipFile* parent, void* reader, const std::string& entry_name,
+                            const char* password, ExceptionSink* xsink);
 
     //! Destructor
     DLLLOCAL virtual ~ZipInputStream();
@@ -73,7 +76,8 @@ public:
 
 private:
     QoreZipFile* parent;    //!< parent ZipFile object (not owned, for reference counting)
-    void* reader;           //!< minizip reader handle (not owned)
+    void* reader;           //!< mz_zip_reader handle checked out for this stream
+    void* zip_handle;       //!< minizip zip handle of the reader
     std::string entry_name; //!< name of the entry being read
     bool entry_open;        //!< true if entry is currently open
     bool eof;               //!< true if end of entry reached
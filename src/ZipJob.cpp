@@ -0,0 +1,116 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipJob.cpp QoreZipJob class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipJob.h"
+#include "QoreZipFile.h"
+#include "ZipThreadPool.h"
+
+#include <chrono>
+
+QoreZipJob::QoreZipJob(QoreZipFile* z, const zip_job_func_t& func) : zf(z), func(func) {
+    zf->ref();
+}
+
+QoreZipJob::~QoreZipJob() {
+}
+
+void QoreZipJob::deref(ExceptionSink* xsink) {
+    if (ROdereference()) {
+        // The operation uses the archive and this object until it has completed
+        wait(-1);
+        if (bin) {
+            bin->deref();
+        } else if (result.data) {
+            free(result.data);
+        }
+        zf->deref(xsink);
+        delete this;
+    }
+}
+
+int QoreZipJob::start(ExceptionSink* xsink) {
+    if (!zip_thread_pool.submit([this] () { run(); })) {
+        result.error.sprintf("failed to start a background thread");
+        rc = -1;
+        complete();
+        xsink->raiseException("ZIP-ERROR", "failed to start a background thread for the asynchronous operation");
+        return -1;
+    }
+    return 0;
+}
+
+void QoreZipJob::run() {
+    rc = func(result);
+    complete();
+}
+
+void QoreZipJob::complete() {
+    // The archive can be closed once the operation no longer uses it
+    zf->derefJob();
+
+    // This object may be deleted as soon as the lock is released after setting the flag
+    std::lock_guard<std::mutex> lock(m);
+    done = true;
+    cond.notify_all();
+}
+
+bool QoreZipJob::poll() {
+    std::lock_guard<std::mutex> lock(m);
+    return done;
+}
+
+bool QoreZipJob::wait(int64 timeout_ms) {
+    std::unique_lock<std::mutex> lock(m);
+    if (timeout_ms < 0) {
+        while (!done) {
+            cond.wait(lock);
+        }
+        return true;
+    }
+    return cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] () { return done; });
+}
+
+BinaryNode* QoreZipJob::getResult(ExceptionSink* xsink) {
+    std::unique_lock<std::mutex> lock(m);
+    while (!done) {
+        cond.wait(lock);
+    }
+
+    if (rc) {
+        xsink->raiseException("ZIP-ERROR", "%s", result.error.c_str());
+        return nullptr;
+    }
+    if (!result.has_data) {
+        return nullptr;
+    }
+    if (!bin) {
+        // Ownership of the data is transferred to the binary object
+        bin = result.data ? new BinaryNode(result.data, result.size) : new BinaryNode();
+        result.data = nullptr;
+    }
+    bin->ref();
+    return bin;
+}
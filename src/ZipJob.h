@@ -0,0 +1,113 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipJob.h QoreZipJob class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _QORE_ZIP_ZIPJOB_H
+#define _QORE_ZIP_ZIPJOB_H
+
+#include "zip-module.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// Forward declarations
+class QoreZipFile;
+
+//! The result of an asynchronous archive operation
+/** Filled in by the operation in a background thread without using the Qore API
+*/
+struct ZipJobResult {
+    char* data = nullptr;       //!< the binary result allocated with malloc(); may be nullptr for empty data
+    int64 size = 0;             //!< the size of \c data
+    bool has_data = false;      //!< true if the operation returns binary data
+    QoreString error;           //!< the error description if the operation failed
+};
+
+//! An asynchronous archive operation; returns 0 on success or -1 on error with ZipJobResult::error set
+typedef std::function<int(ZipJobResult& result)> zip_job_func_t;
+
+//! QoreZipJob - private data class for the ZipJob Qore class
+/** Runs an archive operation in the module-wide ZipThreadPool.  The archive is referenced and marked as having
+    a pending job (see QoreZipFile::refJob()) until the operation has completed, so it cannot be closed while
+    the operation accesses it.  The result is converted to a Qore value or exception by the thread retrieving
+    it.
+*/
+class QoreZipJob : public AbstractPrivateData {
+public:
+    //! Constructor
+    /** @param zf the archive; a reference is held for the lifetime of the job, and QoreZipFile::refJob() must
+        have been called for the job
+        @param func the operation to run
+    */
+    DLLLOCAL QoreZipJob(QoreZipFile* zf, const zip_job_func_t& func);
+
+    //! Submits the operation to the module thread pool
+    /** @return 0 on success, -1 if the operation could not be started (an exception is raised)
+    */
+    DLLLOCAL int start(ExceptionSink* xsink);
+
+    //! Returns true if the operation has completed
+    DLLLOCAL bool poll();
+
+    //! Waits for the operation to complete
+    /** @param timeout_ms the maximum time to wait in milliseconds; a negative value waits indefinitely
+
+        @return true if the operation has completed
+    */
+    DLLLOCAL bool wait(int64 timeout_ms);
+
+    //! Waits for the operation to complete and returns its result
+    /** @return the binary data returned by the operation, or nullptr if it has no result or an error occurred
+        (an exception is raised)
+    */
+    DLLLOCAL BinaryNode* getResult(ExceptionSink* xsink);
+
+    //! Waits for the operation to complete and releases the archive when the last reference is removed
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) override;
+
+protected:
+    DLLLOCAL virtual ~QoreZipJob();
+
+private:
+    QoreZipFile* zf;            //!< the archive the operation is run on
+    zip_job_func_t func;        //!< the operation
+
+    std::mutex m;
+    std::condition_variable cond;   //!< signaled when the operation has completed
+    bool done = false;
+    int rc = 0;                 //!< the return value of the operation
+    ZipJobResult result;
+    BinaryNode* bin = nullptr;  //!< the binary result once it has been retrieved
+
+    //! Runs the operation in a pool thread
+    DLLLOCAL void run();
+
+    //! Marks the operation as complete
+    DLLLOCAL void complete();
+};
+
+#endif // _QORE_ZIP_ZIPJOB_H
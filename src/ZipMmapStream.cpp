@@ -0,0 +1,127 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipMmapStream.cpp ZipMmapStream class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ZipMmapStream.h"
+
+#include <cstring>
+#include <new>
+
+mz_stream_vtbl ZipMmapStream::vtbl = {
+    ZipMmapStream::open,
+    ZipMmapStream::isOpen,
+    ZipMmapStream::read,
+    ZipMmapStream::write,
+    ZipMmapStream::tell,
+    ZipMmapStream::seek,
+    ZipMmapStream::close,
+    ZipMmapStream::getError,
+    nullptr,
+    ZipMmapStream::destroy,
+    nullptr,
+    nullptr,
+};
+
+ZipMmapStream::ZipMmapStream(const char* data, int64 size) : data(data), size(size) {
+    stream.vtbl = &vtbl;
+    stream.base = nullptr;
+}
+
+void* ZipMmapStream::create(const char* data, int64 size) {
+    ZipMmapStream* s = new (std::nothrow) ZipMmapStream(data, size);
+    return s ? &s->stream : nullptr;
+}
+
+bool ZipMmapStream::isMmapStream(void* stream) {
+    return stream && static_cast<mz_stream*>(stream)->vtbl == &vtbl;
+}
+
+int32_t ZipMmapStream::open(void* stream, const char* path, int32_t mode) {
+    // the stream is created open; it cannot be reopened on another file or for writing
+    return (mode & MZ_OPEN_MODE_WRITE) ? MZ_OPEN_ERROR : MZ_OK;
+}
+
+int32_t ZipMmapStream::isOpen(void* stream) {
+    return static_cast<ZipMmapStream*>(stream)->data ? MZ_OK : MZ_OPEN_ERROR;
+}
+
+int32_t ZipMmapStream::read(void* stream, void* dest, int32_t len) {
+    ZipMmapStream* s = static_cast<ZipMmapStream*>(stream);
+    if (len <= 0 || s->pos >= s->size) {
+        return 0;
+    }
+
+    if (len > s->size - s->pos) {
+        len = (int32_t)(s->size - s->pos);
+    }
+    memcpy(dest, s->data + s->pos, len);
+    s->pos += len;
+    return len;
+}
+
+int32_t ZipMmapStream::write(void* stream, const void* src, int32_t len) {
+    static_cast<ZipMmapStream*>(stream)->error = MZ_WRITE_ERROR;
+    return MZ_WRITE_ERROR;
+}
+
+int64_t ZipMmapStream::tell(void* stream) {
+    return static_cast<ZipMmapStream*>(stream)->pos;
+}
+
+int32_t ZipMmapStream::seek(void* stream, int64_t offset, int32_t origin) {
+    ZipMmapStream* s = static_cast<ZipMmapStream*>(stream);
+    int64 new_pos;
+    switch (origin) {
+        case MZ_SEEK_SET: new_pos = offset; break;
+        case MZ_SEEK_CUR: new_pos = s->pos + offset; break;
+        case MZ_SEEK_END: new_pos = s->size + offset; break;
+        default:
+            s->error = MZ_SEEK_ERROR;
+            return MZ_SEEK_ERROR;
+    }
+    if (new_pos < 0) {
+        s->error = MZ_SEEK_ERROR;
+        return MZ_SEEK_ERROR;
+    }
+    s->pos = new_pos;
+    return MZ_OK;
+}
+
+int32_t ZipMmapStream::close(void* stream) {
+    // the mapping belongs to the owner of the stream
+    return MZ_OK;
+}
+
+int32_t ZipMmapStream::getError(void* stream) {
+    return static_cast<ZipMmapStream*>(stream)->error;
+}
+
+void ZipMmapStream::destroy(void** stream) {
+    if (stream && *stream) {
+        delete static_cast<ZipMmapStream*>(*stream);
+        *stream = nullptr;
+    }
+}
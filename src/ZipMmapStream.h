@@ -0,0 +1,75 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipMmapStream.h ZipMmapStream class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _QORE_ZIP_ZIPMMAPSTREAM_H
+#define _QORE_ZIP_ZIPMMAPSTREAM_H
+
+#include "zip-module.h"
+
+//! ZipMmapStream - read-only minizip stream on a memory-mapped archive file
+/** The stream keeps its own position and copies data directly from the mapping, so reads need no system calls
+    and any number of streams can read from the same mapping in parallel.  Unlike minizip's memory stream, the
+    mapping can be larger than 2GB.
+
+    The mapping is not unmapped by the stream; streams are deleted with mz_stream_delete().
+*/
+class ZipMmapStream {
+public:
+    //! Creates an open stream reading from the given mapping
+    /** @param data the start of the mapping; must remain mapped until the stream is deleted
+        @param size the size of the mapped file
+
+        @return a minizip stream or nullptr if no memory can be allocated
+    */
+    DLLLOCAL static void* create(const char* data, int64 size);
+
+    //! Returns true if the given minizip stream was created with create()
+    DLLLOCAL static bool isMmapStream(void* stream);
+
+private:
+    mz_stream stream;                   //!< must be the first member
+    const char* data;
+    int64 size;
+    int64 pos = 0;                      //!< current stream position
+    int32_t error = MZ_OK;              //!< last error
+
+    static mz_stream_vtbl vtbl;
+
+    DLLLOCAL ZipMmapStream(const char* data, int64 size);
+
+    DLLLOCAL static int32_t open(void* stream, const char* path, int32_t mode);
+    DLLLOCAL static int32_t isOpen(void* stream);
+    DLLLOCAL static int32_t read(void* stream, void* dest, int32_t len);
+    DLLLOCAL static int32_t write(void* stream, const void* src, int32_t len);
+    DLLLOCAL static int64_t tell(void* stream);
+    DLLLOCAL static int32_t seek(void* stream, int64_t offset, int32_t origin);
+    DLLLOCAL static int32_t close(void* stream);
+    DLLLOCAL static int32_t getError(void* stream);
+    DLLLOCAL static void destroy(void** stream);
+};
+
+#endif // _QORE_ZIP_ZIPMMAPSTREAM_H
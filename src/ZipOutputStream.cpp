@@ -26,41 +26,146 @@
 
 #include "ZipOutputStream.h"
 #include "QoreZipFile.h"
+#include "ZipSpoolStream.h"
 
-#include <ctime>
+#include <mz_crypt.h>
+
+#include <algorithm>
 #include <cstring>
 
-ZipOutputStream::ZipOutputStream(QoreZipFile* p, void* w, const std::string& name,
-                                  int16_t compression_method, int16_t compression_level,
-                                  ExceptionSink* xsink)
-    : parent(p), writer(w), entry_name(name), entry_open(false), closed(false) {
-    // Set compression options
-    mz_zip_writer_set_compress_method(writer, compression_method);
-    mz_zip_writer_set_compress_level(writer, compression_level);
+ZipOutputStream::ZipOutputStream(QoreZipFile* p, ZipWriteEntry* e, bool raw, const std::string& entry_password,
+                                  size_t pipeline_buffers, ExceptionSink* xsink)
+    : parent(p), entry(e), raw(raw), closed(false) {
+    if (!raw) {
+        int32_t err = openEntryArchive(entry_password);
+        if (err != MZ_OK) {
+            xsink->raiseException("ZIP-STREAM-ERROR", "failed to open entry '%s' for writing: error %d",
+                                  entry->name.c_str(), err);
+            return;
+        }
+    } else if (!entry->isStored()) {
+        ZipWriteEntry* spooled = e;
+        compressor.reset(ZipEntryCompressor::create(entry->compression_method, entry->compression_level,
+            entry->threads, entry->long_window, [spooled] (const char* buf, size_t len) -> int {
+                return spooled->spool.append(buf, len);
+            }));
+    }
+
+    if (pipeline_buffers) {
+        // The data is compressed and spooled by a pool thread while the caller produces the next data
+        pipeline.reset(new ZipWritePipeline(pipeline_buffers, [this] (const char* buf, size_t len) -> int32_t {
+            return writeData(buf, len);
+        }));
+    }
+}
+
+int32_t ZipOutputStream::openEntryArchive(const std::string& entry_password) {
+    entry_stream = ZipSpoolStream::create();
+    entry_writer = mz_zip_writer_create();
+    if (!entry_stream || !entry_writer) {
+        return MZ_MEM_ERROR;
+    }
+    int32_t err = mz_zip_writer_open(entry_writer, entry_stream, 0);
+    if (err != MZ_OK) {
+        return err;
+    }
 
-    // Create file info for the entry
     mz_zip_file file_info;
     memset(&file_info, 0, sizeof(file_info));
-    file_info.filename = entry_name.c_str();
-    file_info.compression_method = compression_method;
-    file_info.modified_date = time(nullptr);
+    file_info.filename = entry->name.c_str();
+    file_info.compression_method = entry->compression_method;
+    file_info.modified_date = entry->modified;
+    if (!entry->comment.empty()) {
+        file_info.comment = entry->comment.c_str();
+        file_info.comment_size = (uint16_t)entry->comment.size();
+    }
 
-    // Open the entry for writing
-    int32_t err = mz_zip_writer_entry_open(writer, &file_info);
-    if (err != MZ_OK) {
-        xsink->raiseException("ZIP-STREAM-ERROR", "failed to open entry '%s' for streaming write: error %d",
-                              entry_name.c_str(), err);
-        return;
+    if (!entry_password.empty()) {
+        mz_zip_writer_set_password(entry_writer, entry_password.c_str());
+        mz_zip_writer_set_aes(entry_writer, 1);
     }
-    entry_open = true;
+    mz_zip_writer_set_compress_method(entry_writer, entry->compression_method);
+    mz_zip_writer_set_compress_level(entry_writer, entry->compression_level);
+    return mz_zip_writer_entry_open(entry_writer, &file_info);
 }
 
-ZipOutputStream::~ZipOutputStream() {
-    if (entry_open && !closed) {
-        // Close the entry if not already closed
-        mz_zip_writer_entry_close(writer);
-        entry_open = false;
+void ZipOutputStream::closeEntryArchive() {
+    if (entry_reader) {
+        mz_zip_reader_close(entry_reader);
+        mz_zip_reader_delete(&entry_reader);
+    }
+    if (entry_writer) {
+        mz_zip_writer_delete(&entry_writer);
+    }
+    if (entry_stream) {
+        mz_stream_delete(&entry_stream);
+    }
+}
+
+int32_t ZipOutputStream::writeData(const char* buf, size_t len) {
+    if (compressor) {
+        return compressor->write(buf, len);
+    }
+    if (!raw) {
+        // The data is compressed and encrypted by minizip as it is written
+        for (size_t done = 0; done < len; ) {
+            int32_t n = (int32_t)std::min(len - done, (size_t)(1 << 30));
+            int32_t rc = mz_zip_writer_entry_write(entry_writer, buf + done, n);
+            if (rc != n) {
+                return rc < 0 ? rc : MZ_WRITE_ERROR;
+            }
+            done += n;
+        }
+        entry->size += len;
+        return MZ_OK;
+    }
+
+    // The CRC of stored entries is calculated here
+    for (size_t done = 0; done < len; ) {
+        int32_t n = (int32_t)std::min(len - done, (size_t)(1 << 30));
+        entry->crc = mz_crypt_crc32_update(entry->crc, (const uint8_t*)buf + done, n);
+        done += n;
     }
+    entry->size += len;
+    return entry->spool.append(buf, len) ? MZ_WRITE_ERROR : MZ_OK;
+}
+
+int32_t ZipOutputStream::finishData() {
+    int32_t err = MZ_OK;
+    if (pipeline) {
+        err = pipeline->finish();
+    }
+
+    if (compressor) {
+        int32_t finish_err = compressor->finish();
+        if (err == MZ_OK) {
+            err = finish_err;
+        }
+        entry->crc = compressor->getCrc();
+        entry->size = compressor->getSize();
+    }
+
+    if (!raw && err == MZ_OK) {
+        // The private archive is completed and opened for reading, so that the entry can be copied as a raw entry
+        err = mz_zip_writer_entry_close(entry_writer);
+        if (err == MZ_OK) {
+            err = mz_zip_writer_close(entry_writer);
+        }
+        if (err == MZ_OK) {
+            entry_reader = mz_zip_reader_create();
+            err = entry_reader ? mz_zip_reader_open(entry_reader, entry_stream) : MZ_MEM_ERROR;
+        }
+        if (err == MZ_OK) {
+            err = mz_zip_reader_goto_first_entry(entry_reader);
+        }
+    }
+    return err;
+}
+
+ZipOutputStream::~ZipOutputStream() {
+    // The pipeline must not write data after the entry has been deleted
+    pipeline.reset();
+    closeEntryArchive();
     // Decrement the parent's active stream count
     if (parent) {
         parent->derefStream();
@@ -71,17 +176,20 @@ void ZipOutputStream::close(ExceptionSink* xsink) {
     if (closed) {
         return;
     }
+    closed = true;
 
-    if (entry_open) {
-        int32_t err = mz_zip_writer_entry_close(writer);
-        if (err != MZ_OK) {
-            xsink->raiseException("ZIP-STREAM-ERROR", "error closing entry '%s': error %d",
-                                  entry_name.c_str(), err);
-        }
-        entry_open = false;
+    int32_t err = finishData();
+    if (err != MZ_OK) {
+        xsink->raiseException("ZIP-STREAM-ERROR", "error closing entry '%s': error %d", entry->name.c_str(), err);
+    } else {
+        parent->commitStreamEntry(*entry, entry_reader, xsink);
     }
 
-    closed = true;
+    // Release the spooled data
+    pipeline.reset();
+    compressor.reset();
+    closeEntryArchive();
+    entry->spool.clear();
 }
 
 void ZipOutputStream::write(const void* ptr, int64 count, ExceptionSink* xsink) {
@@ -90,21 +198,13 @@ void ZipOutputStream::write(const void* ptr, int64 count, ExceptionSink* xsink)
         return;
     }
 
-    if (!entry_open) {
-        xsink->raiseException("ZIP-STREAM-ERROR", "stream is not open");
-        return;
-    }
-
     if (count <= 0) {
         return;
     }
 
-    int32_t bytes_written = mz_zip_writer_entry_write(writer, ptr, static_cast<int32_t>(count));
-    if (bytes_written < 0) {
+    int32_t err = pipeline ? pipeline->write(ptr, (size_t)count) : writeData((const char*)ptr, (size_t)count);
+    if (err != MZ_OK) {
         xsink->raiseException("ZIP-STREAM-ERROR", "error writing to entry '%s': error %d",
-                              entry_name.c_str(), bytes_written);
-    } else if (bytes_written != count) {
-        xsink->raiseException("ZIP-STREAM-ERROR", "incomplete write to entry '%s': wrote %d of %lld bytes",
-                              entry_name.c_str(), bytes_written, (long long)count);
+                              entry->name.c_str(), err);
     }
 }
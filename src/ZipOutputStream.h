@@ -28,30 +28,46 @@
 #define _QORE_ZIP_ZIPOUTPUTSTREAM_H
 
 #include "zip-module.h"
+#include "ZipEntryCompressor.h"
+#include "ZipParallelWriter.h"
+#include "ZipWritePipeline.h"
 #include <qore/OutputStream.h>
 
+#include <memory>
 #include <string>
 
 // Forward declaration
 class QoreZipFile;
 
 //! ZipOutputStream - OutputStream for writing a single entry to a ZIP archive
-/** @note This class is not thread-safe. Only one thread should access
+/** The entry data is compressed as it is written and spooled until the stream is closed: unencrypted stored,
+    deflated and (if available) zstd entries are compressed by the module into a ZipWriteSpool, and other entries
+    are compressed and encrypted by minizip into a private single-entry archive in a ZipSpoolStream, so the data of
+    encrypted entries is never spooled in plain text.  close() adds the entry to the archive as a raw entry,
+    holding the archive write lock only while the spooled data is copied, so any number of streams can be open on
+    an archive at the same time.  Entries are added in the order their streams are closed; the entry of a stream
+    that is destroyed without being closed is discarded.
+
+    With a pipeline, written data is compressed and spooled by a pool thread; errors are raised by a later call to
+    write() or by close().
+
+    @note This class is not thread-safe. Only one thread should access
     an instance at a time.
 */
 class ZipOutputStream : public OutputStream {
 public:
-    //! Constructor - opens entry for writing
+    //! Constructor
     /** @param parent the parent ZipFile object
-        @param writer the minizip writer handle
-        @param entry_name the name of the entry being written
-        @param compression_method compression method to use
-        @param compression_level compression level (0-9)
+        @param entry the entry being written with its name and options; the stream takes ownership of the entry
+        @param raw true if the data is compressed by the module (see ZipParallelWriter::canCompress()), false if
+        it is compressed by minizip
+        @param entry_password the password for an encrypted entry, or an empty string
+        @param pipeline_buffers the number of buffers queued for a pool thread compressing and spooling the data,
+        or 0 to compress and spool the data in the calling thread
         @param xsink exception sink
     */
-    DLLLOCAL ZipOutputStream(QoreZipFile* parent, void* writer, const std::string& entry_name,
-                              int16_t compression_method, int16_t compression_level,
-                              ExceptionSink* xsink);
+    DLLLOCAL ZipOutputStream(QoreZipFile* parent, ZipWriteEntry* entry, bool raw, const std::string& entry_password,
+                              size_t pipeline_buffers, ExceptionSink* xsink);
 
     //! Destructor
     DLLLOCAL virtual ~ZipOutputStream();
@@ -66,7 +82,7 @@ public:
         return closed;
     }
 
-    //! Closes the stream
+    //! Closes the stream and adds the entry to the archive
     /** @param xsink exception sink
     */
     DLLLOCAL virtual void close(ExceptionSink* xsink) override;
@@ -80,10 +96,26 @@ public:
 
 private:
     QoreZipFile* parent;    //!< parent ZipFile object (not owned, for reference counting)
-    void* writer;           //!< minizip writer handle (not owned)
-    std::string entry_name; //!< name of the entry being written
-    bool entry_open;        //!< true if entry is currently open
+    std::unique_ptr<ZipWriteEntry> entry;   //!< the entry with the spooled data
+    bool raw;               //!< true if the data is compressed by the module
     bool closed;            //!< true if stream has been closed
+    std::unique_ptr<ZipEntryCompressor> compressor; //!< set if the data is compressed by the module
+    std::unique_ptr<ZipWritePipeline> pipeline;     //!< set if the data is compressed and spooled by a pool thread
+    void* entry_stream = nullptr;   //!< the private archive of an entry compressed by minizip
+    void* entry_writer = nullptr;   //!< minizip writer compressing the entry into the private archive
+    void* entry_reader = nullptr;   //!< minizip reader positioned on the entry in the completed private archive
+
+    //! Opens the entry in a private archive for an entry compressed by minizip
+    DLLLOCAL int32_t openEntryArchive(const std::string& entry_password);
+
+    //! Deletes the private archive
+    DLLLOCAL void closeEntryArchive();
+
+    //! Compresses and spools data; called by the pipeline in a pool thread
+    DLLLOCAL int32_t writeData(const char* buf, size_t len);
+
+    //! Spools the remaining data and completes the entry
+    DLLLOCAL int32_t finishData();
 };
 
 #endif // _QORE_ZIP_ZIPOUTPUTSTREAM_H
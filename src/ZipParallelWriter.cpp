@@ -0,0 +1,346 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipParallelWriter.cpp ZipParallelWriter class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipParallelWriter.h"
+
+#include <mz_crypt.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//! Maximum size of one chunk of entry data passed to the compressor and minizip
+#define ZIP_WRITE_MAX_CHUNK (1 << 30)
+
+ZipWriteSpool::~ZipWriteSpool() {
+    if (file) {
+        fclose(file);
+    }
+}
+
+int ZipWriteSpool::append(const void* data, size_t n) {
+    if (!file && len + (int64)n > ZIP_WRITE_SPOOL_THRESHOLD) {
+        // Move the data to a temporary file, which is deleted automatically when it is closed
+        file = tmpfile();
+        if (!file || (!mem.empty() && fwrite(&mem[0], 1, mem.size(), file) != mem.size())) {
+            return -1;
+        }
+        std::vector<char>().swap(mem);
+    }
+
+    if (file) {
+        if (fwrite(data, 1, n, file) != n) {
+            return -1;
+        }
+    } else {
+        mem.insert(mem.end(), (const char*)data, (const char*)data + n);
+    }
+    len += n;
+    return 0;
+}
+
+void ZipWriteSpool::clear() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    std::vector<char>().swap(mem);
+    len = 0;
+}
+
+int ZipWriteSpool::read(const std::function<int(const char*, int32_t)>& write) {
+    if (!file) {
+        for (int64 done = 0; done < len; ) {
+            int32_t n = (int32_t)std::min(len - done, (int64)ZIP_WRITE_MAX_CHUNK);
+            if (write(&mem[done], n)) {
+                return -1;
+            }
+            done += n;
+        }
+        return 0;
+    }
+
+    if (fflush(file) || fseek(file, 0, SEEK_SET)) {
+        return -1;
+    }
+    std::vector<char> buf(ZIP_WRITE_BUF_SIZE);
+    for (int64 done = 0; done < len; ) {
+        size_t n = fread(&buf[0], 1, (size_t)std::min(len - done, (int64)ZIP_WRITE_BUF_SIZE), file);
+        if (!n || write(&buf[0], (int32_t)n)) {
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+ZipParallelWriter::ZipParallelWriter(void* writer, unsigned threads)
+    : writer(writer), threads(threads ? threads : 1), max_pending(this->threads * 2),
+      group(this->threads, max_pending) {
+}
+
+ZipParallelWriter::~ZipParallelWriter() {
+    // No task may run after the entries have been deleted
+    group.cancel();
+    group.wait();
+    for (ZipWriteEntry* entry : pending) {
+        delete entry;
+    }
+}
+
+int ZipParallelWriter::add(ZipWriteEntry* entry, QoreString& error) {
+    pending.push_back(entry);
+    if (threads == 1) {
+        compress(*entry);
+        entry->done = true;
+    } else {
+        group.add([this, entry] () {
+            compress(*entry);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                entry->done = true;
+            }
+            cond.notify_all();
+        });
+    }
+
+    return writeQueued(max_pending, error);
+}
+
+int ZipParallelWriter::flush(QoreString& error) {
+    return writeQueued(0, error);
+}
+
+int ZipParallelWriter::writeQueued(size_t keep, QoreString& error) {
+    int rc = 0;
+    while (!pending.empty()) {
+        ZipWriteEntry* entry = pending.front();
+        bool done;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done = entry->done;
+        }
+        if (!done) {
+            if (pending.size() <= keep) {
+                break;
+            }
+            waitFor(entry);
+        }
+
+        pending.pop_front();
+        std::unique_ptr<ZipWriteEntry> holder(entry);
+        int32_t err = entry->err;
+        if (err == MZ_OK) {
+            err = write(writer, *entry);
+        }
+        // Only the first error is reported; the following entries are still written
+        if (err != MZ_OK && !rc) {
+            getError(*entry, err, error);
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
+void ZipParallelWriter::getError(const ZipWriteEntry& entry, int32_t err, QoreString& error) {
+    if (entry.path.empty()) {
+        error.sprintf("failed to add entry '%s': error %d", entry.name.c_str(), err);
+    } else {
+        error.sprintf("failed to add file '%s' as '%s': error %d", entry.path.c_str(), entry.name.c_str(), err);
+    }
+}
+
+void ZipParallelWriter::waitFor(ZipWriteEntry* entry) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (entry->done) {
+                return;
+            }
+        }
+        // If no task is queued, the entry is being compressed by a pool thread
+        if (!group.runOne()) {
+            break;
+        }
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (!entry->done) {
+        cond.wait(guard);
+    }
+}
+
+int32_t ZipParallelWriter::write(void* writer, ZipWriteEntry& entry) {
+    bool stored = entry.isStored();
+
+    mz_zip_file file_info;
+    memset(&file_info, 0, sizeof(file_info));
+    file_info.version_madeby = MZ_VERSION_MADEBY;
+    file_info.flag = MZ_ZIP_FLAG_UTF8;
+    file_info.filename = entry.name.c_str();
+    file_info.compression_method = stored ? MZ_COMPRESS_METHOD_STORE : entry.compression_method;
+    file_info.modified_date = entry.modified;
+    file_info.crc = entry.crc;
+    file_info.uncompressed_size = entry.size;
+    file_info.compressed_size = (stored && entry.data) ? entry.size : entry.spool.size();
+    file_info.external_fa = entry.external_fa;
+    if (!entry.comment.empty()) {
+        file_info.comment = entry.comment.c_str();
+        file_info.comment_size = (uint16_t)entry.comment.size();
+    }
+
+    // The data is already compressed; it is written as is
+    mz_zip_writer_set_password(writer, nullptr);
+    mz_zip_writer_set_compress_method(writer, file_info.compression_method);
+    mz_zip_writer_set_compress_level(writer, stored ? 0 : entry.compression_level);
+    mz_zip_writer_set_raw(writer, 1);
+
+    int32_t err = mz_zip_writer_entry_open(writer, &file_info);
+    if (err == MZ_OK) {
+        auto write_chunk = [writer, &err] (const char* buf, int32_t len) -> int {
+            int32_t rc = mz_zip_writer_entry_write(writer, buf, len);
+            if (rc != len) {
+                err = rc < 0 ? rc : MZ_WRITE_ERROR;
+                return -1;
+            }
+            return 0;
+        };
+
+        if (stored && entry.data) {
+            const char* p = (const char*)entry.data->getPtr();
+            for (int64 done = 0; done < entry.size && err == MZ_OK; ) {
+                int32_t n = (int32_t)std::min(entry.size - done, (int64)ZIP_WRITE_MAX_CHUNK);
+                write_chunk(p + done, n);
+                done += n;
+            }
+        } else if (entry.spool.read(write_chunk) && err == MZ_OK) {
+            err = MZ_READ_ERROR;
+        }
+
+        int32_t close_err = mz_zip_writer_entry_close(writer);
+        if (err == MZ_OK) {
+            err = close_err;
+        }
+    }
+
+    mz_zip_writer_set_raw(writer, 0);
+    return err;
+}
+
+void ZipParallelWriter::compress(ZipWriteEntry& entry) {
+    static thread_local std::vector<char> in_buf;
+
+    bool stored = entry.isStored();
+
+    // Large deflated entries can be compressed in blocks by several threads
+    std::unique_ptr<ZipEntryCompressor> compressor;
+    if (!stored) {
+        compressor.reset(ZipEntryCompressor::create(entry.compression_method, entry.compression_level,
+            entry.threads, entry.long_window, [&entry] (const char* buf, size_t len) -> int {
+                return entry.spool.append(buf, len);
+            }));
+        if (!compressor) {
+            entry.err = MZ_SUPPORT_ERROR;
+            return;
+        }
+    }
+
+    // Processes one chunk of source data; the last call has \a finish set
+    auto process = [&] (const char* buf, size_t len, bool finish) -> int32_t {
+        if (compressor) {
+            // The CRC is calculated by the compressor
+            int32_t rc = compressor->write(buf, len);
+            if (rc == MZ_OK && finish) {
+                rc = compressor->finish();
+                entry.crc = compressor->getCrc();
+                entry.size = compressor->getSize();
+            }
+            return rc;
+        }
+        if (len) {
+            entry.crc = mz_crypt_crc32_update(entry.crc, (const uint8_t*)buf, (int32_t)len);
+            entry.size += len;
+        }
+        // Stored entry data is written directly from memory sources
+        return (entry.data || !len || !entry.spool.append(buf, len)) ? MZ_OK : MZ_WRITE_ERROR;
+    };
+
+    int32_t err = MZ_OK;
+    if (entry.data) {
+        const char* p = (const char*)entry.data->getPtr();
+        int64 size = entry.data->size();
+        int64 done = 0;
+        do {
+            size_t n = (size_t)std::min(size - done, (int64)ZIP_WRITE_MAX_CHUNK);
+            done += n;
+            err = process(p + done - n, n, done == size);
+        } while (err == MZ_OK && done < size);
+    } else {
+        int fd = open(entry.path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st)) {
+            err = MZ_OPEN_ERROR;
+        } else {
+            // The same metadata as minizip stores for files added with mz_zip_writer_add_file()
+            if (!entry.modified) {
+                entry.modified = st.st_mtime;
+            }
+            uint32_t dos_attrib = 0;
+            if (mz_zip_attrib_convert(MZ_HOST_SYSTEM(MZ_VERSION_MADEBY), st.st_mode, MZ_HOST_SYSTEM_MSDOS,
+                                      &dos_attrib) == MZ_OK) {
+                entry.external_fa = dos_attrib;
+            }
+            entry.external_fa |= ((uint32_t)st.st_mode << 16);
+
+            // Directory entries have no data
+            in_buf.resize(ZIP_WRITE_BUF_SIZE);
+            while (err == MZ_OK && !entry.directory) {
+                ssize_t rc = ::read(fd, &in_buf[0], in_buf.size());
+                if (rc < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (rc < 0) {
+                    err = MZ_READ_ERROR;
+                    break;
+                }
+                err = process(&in_buf[0], rc, !rc);
+                if (!rc) {
+                    break;
+                }
+            }
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    entry.err = err;
+}
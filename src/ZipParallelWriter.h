@@ -0,0 +1,208 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipParallelWriter.h ZipParallelWriter class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPPARALLELWRITER_H
+#define _QORE_ZIP_ZIPPARALLELWRITER_H
+
+#include "zip-module.h"
+#include "ZipEntryCompressor.h"
+#include "ZipThreadPool.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! Size of compressed entry data kept in memory until the entry is written; larger entries are spooled to a temporary file (16MB)
+#define ZIP_WRITE_SPOOL_THRESHOLD (16 * 1024 * 1024)
+
+//! Size of the buffers used to read source files and to compress entry data (256KB)
+#define ZIP_WRITE_BUF_SIZE (256 * 1024)
+
+//! ZipWriteSpool - compressed entry data waiting to be written to the archive
+/** Data is kept in memory up to ZIP_WRITE_SPOOL_THRESHOLD bytes and in an anonymous temporary file beyond that.
+    Does not use the Qore API.
+*/
+class ZipWriteSpool {
+public:
+    DLLLOCAL ZipWriteSpool() {
+    }
+
+    DLLLOCAL ~ZipWriteSpool();
+
+    //! Appends data to the spool
+    /** @return 0 on success, -1 if the temporary file cannot be created or written
+    */
+    DLLLOCAL int append(const void* data, size_t len);
+
+    //! Returns the number of bytes in the spool
+    DLLLOCAL int64 size() const {
+        return len;
+    }
+
+    //! Discards the data in the spool
+    DLLLOCAL void clear();
+
+    //! Returns the data in the spool chunk by chunk with the given callback in the order it was appended
+    /** @param write called for each chunk; returns 0 to continue or -1 to stop
+
+        @return 0 on success, -1 if the callback failed or the temporary file could not be read
+    */
+    DLLLOCAL int read(const std::function<int(const char*, int32_t)>& write);
+
+private:
+    std::vector<char> mem;
+    FILE* file = nullptr;               //!< temporary file once the threshold has been exceeded
+    int64 len = 0;
+
+    DLLLOCAL ZipWriteSpool(const ZipWriteSpool&) = delete;
+    DLLLOCAL ZipWriteSpool& operator=(const ZipWriteSpool&) = delete;
+};
+
+//! An entry added to an archive by a ZipParallelWriter
+struct ZipWriteEntry {
+    //! @name Set by the caller
+    //@{
+    std::string name;
+    std::string comment;
+    int64 modified = 0;                 //!< modification time; 0 for the modification time of the source file
+    int16_t compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+    int16_t compression_level = MZ_COMPRESS_LEVEL_DEFAULT;
+    const BinaryNode* data = nullptr;   //!< the entry data, or nullptr if the data is read from \c path
+    std::string path;                   //!< the source file
+    unsigned threads = 0;               //!< the number of threads compressing the data; 0 for the calling thread only
+    bool long_window = false;           //!< true for zstd long distance matching
+    bool directory = false;             //!< true for a directory entry with the metadata of the directory \c path
+    //@}
+
+    //! @name Set when the entry has been compressed
+    //@{
+    ZipWriteSpool spool;                //!< the compressed data; empty for stored entries with \c data
+    uint32_t crc = 0;
+    int64 size = 0;                     //!< the uncompressed size
+    uint32_t external_fa = 0;           //!< file attributes of the source file
+    int32_t err = MZ_OK;                //!< minizip error code if the entry could not be compressed
+    bool done = false;                  //!< set under the writer lock when compression is complete
+    //@}
+
+    //! Releases the entry data; must be destroyed in a Qore thread
+    DLLLOCAL ~ZipWriteEntry() {
+        if (data) {
+            const_cast<BinaryNode*>(data)->deref();
+        }
+    }
+
+    //! Returns true if the entry is stored without compression
+    DLLLOCAL bool isStored() const {
+        return compression_method == MZ_COMPRESS_METHOD_STORE || !compression_level;
+    }
+};
+
+//! A list of entries to add in one batch
+typedef std::vector<std::unique_ptr<ZipWriteEntry>> ZipWriteEntryList;
+
+//! ZipParallelWriter - compresses entries in the module thread pool and writes them in the order they were added
+/** Entries are compressed by the calling thread and the pool threads of a ZipTaskGroup into a ZipWriteSpool each;
+    the calling thread writes them to the archive as raw entries in the order they were added, so the archive
+    is the same for any number of threads.  At most twice the number of threads entries are compressed or
+    waiting to be written at any time.  The data of compressed entries is compressed by a ZipEntryCompressor of its
+    own, which also compresses deflated entries with ZipWriteEntry::threads set in blocks by several threads.
+
+    Only unencrypted stored, deflated and (if available) zstd entries can be compressed in parallel (see
+    canCompress()); for other entries, call flush() and add them to the archive directly.
+
+    Compression does not use the Qore API; all other methods must be called in the thread holding the archive
+    write lock.
+*/
+class ZipParallelWriter {
+public:
+    //! Creates the writer for the given mz_zip_writer handle and number of threads including the calling thread
+    DLLLOCAL ZipParallelWriter(void* writer, unsigned threads);
+
+    //! Discards entries that have not been written yet
+    DLLLOCAL ~ZipParallelWriter();
+
+    //! Queues an entry for compression and writes the completed entries at the head of the queue
+    /** Takes ownership of the entry.  Errors compressing or writing an entry are returned by the call that
+        writes it, which can be a later call to add() or flush().
+
+        @return 0 on success, -1 if an entry could not be compressed or written (\a error is set)
+    */
+    DLLLOCAL int add(ZipWriteEntry* entry, QoreString& error);
+
+    //! Writes all queued entries to the archive, waiting for their compression to complete
+    /** All entries are written or discarded, even if an error occurs
+
+        @return 0 on success, -1 if an entry could not be compressed or written (\a error is set)
+    */
+    DLLLOCAL int flush(QoreString& error);
+
+    //! Compresses the entry data into the entry's spool; does not use the Qore API
+    /** Sets ZipWriteEntry::err on error
+    */
+    DLLLOCAL static void compress(ZipWriteEntry& entry);
+
+    //! Writes a compressed entry to the archive as a raw entry (must be called with the archive write lock held)
+    /** @param writer the mz_zip_writer handle
+        @param entry the entry compressed with compress()
+
+        @return MZ_OK on success, otherwise a minizip error code
+    */
+    DLLLOCAL static int32_t write(void* writer, ZipWriteEntry& entry);
+
+    //! Sets the error message for an entry that could not be compressed or written
+    DLLLOCAL static void getError(const ZipWriteEntry& entry, int32_t err, QoreString& error);
+
+    //! Returns true if entries with the given compression method and encryption can be compressed in parallel
+    DLLLOCAL static bool canCompress(int16_t compression_method, bool encrypted) {
+        return !encrypted
+            && (compression_method == MZ_COMPRESS_METHOD_STORE || ZipEntryCompressor::isSupported(compression_method));
+    }
+
+private:
+    void* writer;                       //!< mz_zip_writer handle
+    unsigned threads;
+    size_t max_pending;                 //!< the maximum number of entries compressed or waiting to be written
+    std::mutex lock;
+    std::condition_variable cond;       //!< signaled when an entry has been compressed
+    std::deque<ZipWriteEntry*> pending; //!< entries not yet written, in the order they were added
+    ZipTaskGroup group;
+
+    DLLLOCAL ZipParallelWriter(const ZipParallelWriter&) = delete;
+    DLLLOCAL ZipParallelWriter& operator=(const ZipParallelWriter&) = delete;
+
+    //! Writes completed entries at the head of the queue; waits for entries while more than \a keep are queued
+    DLLLOCAL int writeQueued(size_t keep, QoreString& error);
+
+    //! Waits until the given entry has been compressed, running queued tasks in the calling thread meanwhile
+    DLLLOCAL void waitFor(ZipWriteEntry* entry);
+};
+
+#endif // _QORE_ZIP_ZIPPARALLELWRITER_H
@@ -0,0 +1,179 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipPreadStream.cpp ZipPreadStream class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipPreadStream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <unistd.h>
+
+mz_stream_vtbl ZipPreadStream::vtbl = {
+    ZipPreadStream::open,
+    ZipPreadStream::isOpen,
+    ZipPreadStream::read,
+    ZipPreadStream::write,
+    ZipPreadStream::tell,
+    ZipPreadStream::seek,
+    ZipPreadStream::close,
+    ZipPreadStream::getError,
+    nullptr,
+    ZipPreadStream::destroy,
+    nullptr,
+    nullptr,
+};
+
+ZipPreadStream::ZipPreadStream(int fd, int64 size) : fd(fd), size(size) {
+    stream.vtbl = &vtbl;
+    stream.base = nullptr;
+}
+
+void* ZipPreadStream::create(int fd, int64 size) {
+    ZipPreadStream* s = new (std::nothrow) ZipPreadStream(fd, size);
+    return s ? &s->stream : nullptr;
+}
+
+bool ZipPreadStream::isPreadStream(void* stream) {
+    return stream && static_cast<mz_stream*>(stream)->vtbl == &vtbl;
+}
+
+int64 ZipPreadStream::readAt(void* dest, int64 len, int64 offset) {
+    int64 done = 0;
+    while (done < len) {
+        ssize_t rc = pread(fd, (char*)dest + done, len - done, offset + done);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc < 0) {
+            return -1;
+        }
+        if (!rc) {
+            break;
+        }
+        done += rc;
+    }
+    return done;
+}
+
+int32_t ZipPreadStream::open(void* stream, const char* path, int32_t mode) {
+    // the stream is created open; it cannot be reopened on another file or for writing
+    return (mode & MZ_OPEN_MODE_WRITE) ? MZ_OPEN_ERROR : MZ_OK;
+}
+
+int32_t ZipPreadStream::isOpen(void* stream) {
+    return static_cast<ZipPreadStream*>(stream)->fd >= 0 ? MZ_OK : MZ_OPEN_ERROR;
+}
+
+int32_t ZipPreadStream::read(void* stream, void* dest, int32_t len) {
+    ZipPreadStream* s = static_cast<ZipPreadStream*>(stream);
+    if (len <= 0) {
+        return 0;
+    }
+
+    int32_t done = 0;
+    while (done < len) {
+        // serve the request from the buffer as far as possible
+        if (s->pos >= s->buf_pos && s->pos < s->buf_pos + s->buf_len) {
+            int32_t off = (int32_t)(s->pos - s->buf_pos);
+            int32_t n = s->buf_len - off;
+            if (n > len - done) {
+                n = len - done;
+            }
+            memcpy((char*)dest + done, s->buf + off, n);
+            done += n;
+            s->pos += n;
+            continue;
+        }
+
+        // large reads bypass the buffer
+        int64 rc;
+        if (len - done >= ZIP_PREAD_STREAM_BUF_SIZE) {
+            rc = s->readAt((char*)dest + done, len - done, s->pos);
+            if (rc > 0) {
+                done += (int32_t)rc;
+                s->pos += rc;
+            }
+        } else {
+            rc = s->readAt(s->buf, ZIP_PREAD_STREAM_BUF_SIZE, s->pos);
+            s->buf_pos = s->pos;
+            s->buf_len = rc > 0 ? (int32_t)rc : 0;
+        }
+        if (rc < 0) {
+            s->error = MZ_READ_ERROR;
+            return MZ_READ_ERROR;
+        }
+        if (!rc) {
+            // end of file
+            break;
+        }
+    }
+    return done;
+}
+
+int32_t ZipPreadStream::write(void* stream, const void* src, int32_t len) {
+    static_cast<ZipPreadStream*>(stream)->error = MZ_WRITE_ERROR;
+    return MZ_WRITE_ERROR;
+}
+
+int64_t ZipPreadStream::tell(void* stream) {
+    return static_cast<ZipPreadStream*>(stream)->pos;
+}
+
+int32_t ZipPreadStream::seek(void* stream, int64_t offset, int32_t origin) {
+    ZipPreadStream* s = static_cast<ZipPreadStream*>(stream);
+    int64 new_pos;
+    switch (origin) {
+        case MZ_SEEK_SET: new_pos = offset; break;
+        case MZ_SEEK_CUR: new_pos = s->pos + offset; break;
+        case MZ_SEEK_END: new_pos = s->size + offset; break;
+        default:
+            s->error = MZ_SEEK_ERROR;
+            return MZ_SEEK_ERROR;
+    }
+    if (new_pos < 0) {
+        s->error = MZ_SEEK_ERROR;
+        return MZ_SEEK_ERROR;
+    }
+    s->pos = new_pos;
+    return MZ_OK;
+}
+
+int32_t ZipPreadStream::close(void* stream) {
+    // the file descriptor belongs to the owner of the stream
+    return MZ_OK;
+}
+
+int32_t ZipPreadStream::getError(void* stream) {
+    return static_cast<ZipPreadStream*>(stream)->error;
+}
+
+void ZipPreadStream::destroy(void** stream) {
+    if (stream && *stream) {
+        delete static_cast<ZipPreadStream*>(*stream);
+        *stream = nullptr;
+    }
+}
@@ -0,0 +1,85 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipPreadStream.h ZipPreadStream class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPPREADSTREAM_H
+#define _QORE_ZIP_ZIPPREADSTREAM_H
+
+#include "zip-module.h"
+
+//! Size of the read buffer of a ZipPreadStream (8KB)
+#define ZIP_PREAD_STREAM_BUF_SIZE (8 * 1024)
+
+//! ZipPreadStream - read-only minizip stream on a shared file descriptor
+/** The stream keeps its own position and reads with pread(), so any number of streams can read from the same file
+    descriptor in parallel without seeking it.  Reads smaller than ZIP_PREAD_STREAM_BUF_SIZE are served from a
+    buffer, since minizip reads headers a few bytes at a time.
+
+    The file descriptor is not closed by the stream; streams are deleted with mz_stream_delete().
+*/
+class ZipPreadStream {
+public:
+    //! Creates an open stream reading from the given file descriptor
+    /** @param fd the file descriptor; must remain open until the stream is deleted
+        @param size the size of the file
+
+        @return a minizip stream or nullptr if no memory can be allocated
+    */
+    DLLLOCAL static void* create(int fd, int64 size);
+
+    //! Returns true if the given minizip stream was created with create()
+    DLLLOCAL static bool isPreadStream(void* stream);
+
+private:
+    mz_stream stream;                   //!< must be the first member
+    int fd;
+    int64 size;                         //!< file size for seeks relative to the end of the file
+    int64 pos = 0;                      //!< current stream position
+    int32_t error = MZ_OK;              //!< last error
+    int64 buf_pos = 0;                  //!< file position of the buffered data
+    int32_t buf_len = 0;                //!< number of bytes buffered
+    char buf[ZIP_PREAD_STREAM_BUF_SIZE];
+
+    static mz_stream_vtbl vtbl;
+
+    DLLLOCAL ZipPreadStream(int fd, int64 size);
+
+    //! Reads exactly \a len bytes at the given position unless the end of the file is reached
+    /** @return the number of bytes read or -1 on error
+    */
+    DLLLOCAL int64 readAt(void* dest, int64 len, int64 offset);
+
+    DLLLOCAL static int32_t open(void* stream, const char* path, int32_t mode);
+    DLLLOCAL static int32_t isOpen(void* stream);
+    DLLLOCAL static int32_t read(void* stream, void* dest, int32_t len);
+    DLLLOCAL static int32_t write(void* stream, const void* src, int32_t len);
+    DLLLOCAL static int64_t tell(void* stream);
+    DLLLOCAL static int32_t seek(void* stream, int64_t offset, int32_t origin);
+    DLLLOCAL static int32_t close(void* stream);
+    DLLLOCAL static int32_t getError(void* stream);
+    DLLLOCAL static void destroy(void** stream);
+};
+
+#endif // _QORE_ZIP_ZIPPREADSTREAM_H
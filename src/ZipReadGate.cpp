@@ -0,0 +1,58 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipReadGate.cpp ZipReadGate class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipReadGate.h"
+
+#include <chrono>
+#include <thread>
+
+unsigned ZipReadGate::getSlot() {
+    static std::atomic<unsigned> next_slot{0};
+    // each thread is assigned a slot the first time it enters a gate
+    static thread_local unsigned slot = next_slot.fetch_add(1, std::memory_order_relaxed) % ZIP_READ_GATE_SLOTS;
+    return slot;
+}
+
+int ZipReadGate::getReaders() const {
+    int rv = 0;
+    for (unsigned i = 0; i < ZIP_READ_GATE_SLOTS; ++i) {
+        rv += slots[i].count.load(std::memory_order_seq_cst);
+    }
+    return rv;
+}
+
+void ZipReadGate::close() {
+    is_open.store(false, std::memory_order_seq_cst);
+
+    // readers only hold the gate for the duration of a single call, so spin briefly before sleeping
+    for (unsigned i = 0; getReaders(); ++i) {
+        if (i < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
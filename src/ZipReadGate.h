@@ -0,0 +1,134 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipReadGate.h ZipReadGate class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPREADGATE_H
+#define _QORE_ZIP_ZIPREADGATE_H
+
+#include "zip-module.h"
+
+#include <atomic>
+
+//! Number of reader count slots in a ZipReadGate
+#define ZIP_READ_GATE_SLOTS 16
+
+//! ZipReadGate - lock-free admission for read operations on an immutable archive snapshot
+/** Read operations enter the gate instead of acquiring a lock; the entry index and reader pool of an archive
+    opened for reading are never modified while the gate is open, so readers need no further synchronization.
+    close() shuts the gate and waits until all readers that entered it have left, after which the snapshot can be
+    retired.
+
+    Readers are counted in several slots padded to the size of a cache line, so threads reading in parallel do not
+    all update the same cache line.
+
+    This class is thread-safe.
+*/
+class ZipReadGate {
+public:
+    DLLLOCAL ZipReadGate() {
+        for (unsigned i = 0; i < ZIP_READ_GATE_SLOTS; ++i) {
+            slots[i].count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //! Enters the gate
+    /** @param slot set to the slot that must be passed to leave()
+
+        @return true if the gate is open; if false is returned, leave() must not be called
+    */
+    DLLLOCAL bool enter(unsigned& slot) {
+        slot = getSlot();
+        // the increment must be visible before is_open is checked, so that close() either sees this reader or
+        // this reader sees the gate closed
+        slots[slot].count.fetch_add(1, std::memory_order_seq_cst);
+        if (!is_open.load(std::memory_order_seq_cst)) {
+            slots[slot].count.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+        return true;
+    }
+
+    //! Leaves the gate after a successful enter()
+    DLLLOCAL void leave(unsigned slot) {
+        slots[slot].count.fetch_sub(1, std::memory_order_release);
+    }
+
+    //! Opens the gate for readers
+    DLLLOCAL void open() {
+        is_open.store(true, std::memory_order_seq_cst);
+    }
+
+    //! Closes the gate and waits until all readers have left it
+    DLLLOCAL void close();
+
+    //! Returns true if the gate is open
+    DLLLOCAL bool isOpen() const {
+        return is_open.load(std::memory_order_acquire);
+    }
+
+private:
+    //! A reader count padded to the size of a cache line
+    struct Slot {
+        std::atomic<int> count;
+        char pad[64 - sizeof(std::atomic<int>)];
+    };
+
+    Slot slots[ZIP_READ_GATE_SLOTS];
+    std::atomic<bool> is_open{false};
+
+    DLLLOCAL ZipReadGate(const ZipReadGate&) = delete;
+    DLLLOCAL ZipReadGate& operator=(const ZipReadGate&) = delete;
+
+    //! Returns the slot for the current thread
+    DLLLOCAL static unsigned getSlot();
+
+    //! Returns the number of readers in the gate
+    DLLLOCAL int getReaders() const;
+};
+
+//! Holds a ZipReadGate open for the lifetime of the object
+class ZipReadGuard {
+public:
+    //! Enters the gate; check the result with operator bool
+    DLLLOCAL ZipReadGuard(ZipReadGate& gate) : gate(gate), entered(gate.enter(slot)) {
+    }
+
+    DLLLOCAL ~ZipReadGuard() {
+        if (entered) {
+            gate.leave(slot);
+        }
+    }
+
+    DLLLOCAL operator bool() const {
+        return entered;
+    }
+
+private:
+    ZipReadGate& gate;
+    unsigned slot;
+    bool entered;
+};
+
+#endif // _QORE_ZIP_ZIPREADGATE_H
@@ -0,0 +1,222 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipReaderPool.cpp ZipReaderPool class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipReaderPool.h"
+#include "ZipMmapStream.h"
+#include "ZipPreadStream.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+void ZipReaderPool::setFile(const std::string& new_path, int new_fd, int64 size, bool mmap) {
+    AutoLocker al(lock);
+    closeFile();
+    path = new_path;
+    fd = new_fd;
+    file_size = size;
+    use_mmap = mmap;
+}
+
+void ZipReaderPool::setBuffer(const BinaryNode* new_data) {
+    AutoLocker al(lock);
+    if (data) {
+        const_cast<BinaryNode*>(data)->deref();
+    }
+    if (new_data) {
+        new_data->ref();
+    }
+    data = new_data;
+}
+
+void* ZipReaderPool::acquire(int32_t& err) {
+    {
+        AutoLocker al(lock);
+        if (!idle.empty()) {
+            void* reader = idle.back();
+            idle.pop_back();
+            return reader;
+        }
+    }
+
+    // Opening reads the end of the archive, so it is done without holding the lock
+    return open(err);
+}
+
+void* ZipReaderPool::acquire(ExceptionSink* xsink) {
+    int32_t err = MZ_OK;
+    void* reader = acquire(err);
+    if (!reader) {
+        if (path.empty()) {
+            xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive from binary data: error %d", err);
+        } else {
+            xsink->raiseException("ZIP-ERROR", "failed to open ZIP archive '%s' for reading: error %d",
+                                  path.c_str(), err);
+        }
+    }
+    return reader;
+}
+
+void ZipReaderPool::release(void* reader) {
+    {
+        AutoLocker al(lock);
+        if (idle.size() < ZIP_READER_POOL_MAX_IDLE) {
+            idle.push_back(reader);
+            return;
+        }
+    }
+    close(reader);
+}
+
+void ZipReaderPool::clear() {
+    AutoLocker al(lock);
+    for (void* reader : idle) {
+        close(reader);
+    }
+    idle.clear();
+    closeFile();
+    if (data) {
+        const_cast<BinaryNode*>(data)->deref();
+        data = nullptr;
+    }
+}
+
+void* ZipReaderPool::open(int32_t& err) {
+    void* reader = mz_zip_reader_create();
+    if (!reader) {
+        err = MZ_MEM_ERROR;
+        return nullptr;
+    }
+
+    if (data) {
+        err = mz_zip_reader_open_buffer(reader, (const uint8_t*)data->getPtr(), data->size(), 0);
+    } else {
+        void* stream;
+        if (use_mmap) {
+            const char* mapped;
+            int64 size;
+            if (getMapping(mapped, size, err)) {
+                mz_zip_reader_delete(&reader);
+                return nullptr;
+            }
+            stream = ZipMmapStream::create(mapped, size);
+        } else {
+            int64 size;
+            int file = getFile(size, err);
+            if (file < 0) {
+                mz_zip_reader_delete(&reader);
+                return nullptr;
+            }
+            stream = ZipPreadStream::create(file, size);
+        }
+        if (!stream) {
+            mz_zip_reader_delete(&reader);
+            err = MZ_MEM_ERROR;
+            return nullptr;
+        }
+
+        err = mz_zip_reader_open(reader, stream);
+        if (err != MZ_OK) {
+            mz_stream_delete(&stream);
+        }
+    }
+    if (err != MZ_OK) {
+        mz_zip_reader_delete(&reader);
+        return nullptr;
+    }
+
+    return reader;
+}
+
+int ZipReaderPool::getFile(int64& size, int32_t& err) {
+    AutoLocker al(lock);
+    if (fd < 0) {
+        err = MZ_OPEN_ERROR;
+        return -1;
+    }
+
+    size = file_size;
+    return fd;
+}
+
+int ZipReaderPool::getMapping(const char*& mapped, int64& size, int32_t& err) {
+    err = MZ_OK;
+    if (!use_mmap) {
+        return -1;
+    }
+
+    // Once the file has been mapped, the mapping and file size do not change until the pool is cleared
+    const char* p = map.load(std::memory_order_acquire);
+    if (p) {
+        mapped = p;
+        size = file_size;
+        return 0;
+    }
+
+    AutoLocker al(lock);
+    if (!map) {
+        // An empty file cannot be mapped, but it is not a valid archive either
+        void* addr = (fd >= 0 && file_size) ? mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (addr == MAP_FAILED) {
+            err = MZ_OPEN_ERROR;
+            return -1;
+        }
+        map.store((const char*)addr, std::memory_order_release);
+        // The mapping remains valid after the file descriptor has been closed
+        ::close(fd);
+        fd = -1;
+    }
+
+    mapped = map.load(std::memory_order_relaxed);
+    size = file_size;
+    return 0;
+}
+
+void ZipReaderPool::closeFile() {
+    const char* p = map.load(std::memory_order_relaxed);
+    if (p) {
+        munmap((void*)p, file_size);
+        map.store(nullptr, std::memory_order_relaxed);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void ZipReaderPool::close(void* reader) {
+    // Streams opened on the shared file descriptor or mapping are not owned by the reader handle
+    void* stream = nullptr;
+    mz_zip_get_stream(getZipHandle(reader), &stream);
+    if (!ZipPreadStream::isPreadStream(stream) && !ZipMmapStream::isMmapStream(stream)) {
+        stream = nullptr;
+    }
+
+    mz_zip_reader_close(reader);
+    mz_zip_reader_delete(&reader);
+    if (stream) {
+        mz_stream_delete(&stream);
+    }
+}
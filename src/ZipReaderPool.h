@@ -0,0 +1,177 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipReaderPool.h ZipReaderPool class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPREADERPOOL_H
+#define _QORE_ZIP_ZIPREADERPOOL_H
+
+#include "zip-module.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+//! Maximum number of idle reader handles kept open per archive
+#define ZIP_READER_POOL_MAX_IDLE 16
+
+//! ZipReaderPool - independent minizip reader handles for one archive opened for reading
+/** Each reader handle has its own file descriptor or memory stream and its own directory cursor and entry
+    state, so operations that check out different handles can read and decompress entries in parallel.  Handles
+    are opened on demand and returned to the pool when the operation is done; at most ZIP_READER_POOL_MAX_IDLE
+    idle handles are kept open.
+
+    Reader handles for an archive file all read from one file descriptor with ZipPreadStream, so the number of
+    handles open does not count against the process file descriptor limit.  If the archive file is memory-mapped,
+    the file is mapped once and all reader handles read from the mapping with ZipMmapStream, so reading entries
+    needs no system calls.
+
+    This class is thread-safe.
+*/
+class ZipReaderPool {
+public:
+    DLLLOCAL ZipReaderPool() {
+    }
+
+    DLLLOCAL ~ZipReaderPool() {
+        clear();
+    }
+
+    //! Sets the archive file that reader handles are opened for
+    /** @param path the archive file path, used in error messages
+        @param fd a file descriptor open on the archive file; the pool takes ownership of the descriptor
+        @param size the size of the archive file
+        @param mmap true to map the archive file into memory when it is first read
+    */
+    DLLLOCAL void setFile(const std::string& path, int fd, int64 size, bool mmap = false);
+
+    //! Sets the archive data that reader handles are opened for; a reference to the data is held
+    DLLLOCAL void setBuffer(const BinaryNode* data);
+
+    //! Checks out a reader handle
+    /** @param err set to the minizip error code if no handle can be opened
+
+        @return an mz_zip_reader handle or nullptr on error
+    */
+    DLLLOCAL void* acquire(int32_t& err);
+
+    //! Checks out a reader handle; raises a Qore exception if no handle can be opened
+    DLLLOCAL void* acquire(ExceptionSink* xsink);
+
+    //! Returns a reader handle checked out with acquire()
+    DLLLOCAL void release(void* reader);
+
+    //! Closes all idle reader handles and releases the archive source; no handles may be checked out
+    DLLLOCAL void clear();
+
+    //! Returns the memory-mapped archive file, mapping it if necessary
+    /** The mapping remains valid until clear() is called or another archive source is set.
+
+        @param data set to the start of the mapping
+        @param size set to the size of the archive file
+        @param err set to the minizip error code if the file cannot be mapped
+
+        @return 0 on success, -1 if the archive file is not memory-mapped (\a err is \c MZ_OK) or cannot be mapped
+    */
+    DLLLOCAL int getMapping(const char*& data, int64& size, int32_t& err);
+
+    //! Returns true if the archive file is memory-mapped when it is read
+    DLLLOCAL bool isMapped() const {
+        return use_mmap;
+    }
+
+    //! Returns the mz_zip handle of the given reader handle
+    DLLLOCAL static void* getZipHandle(void* reader) {
+        void* zip_handle = nullptr;
+        mz_zip_reader_get_zip_handle(reader, &zip_handle);
+        return zip_handle;
+    }
+
+private:
+    QoreThreadLock lock;
+    std::vector<void*> idle;            //!< reader handles available for checkout
+    std::string path;                   //!< archive file path for error messages, empty for in-memory archives
+    const BinaryNode* data = nullptr;   //!< archive data for in-memory archives
+    int fd = -1;                        //!< archive file descriptor shared by all reader handles
+    int64 file_size = 0;                //!< archive file size
+    bool use_mmap = false;              //!< true if the archive file is memory-mapped
+    std::atomic<const char*> map{nullptr};  //!< the memory-mapped archive file; set once under the lock
+
+    //! Returns the archive file descriptor
+    /** @return the file descriptor or -1 on error (\a err is set)
+    */
+    DLLLOCAL int getFile(int64& size, int32_t& err);
+
+    //! Closes the archive file descriptor and unmaps the archive file (must be called with the lock held)
+    DLLLOCAL void closeFile();
+
+    DLLLOCAL ZipReaderPool(const ZipReaderPool&) = delete;
+    DLLLOCAL ZipReaderPool& operator=(const ZipReaderPool&) = delete;
+
+    //! Opens a new reader handle
+    DLLLOCAL void* open(int32_t& err);
+
+    DLLLOCAL static void close(void* reader);
+};
+
+//! Checks out a reader handle for the lifetime of the object
+class ZipReaderHolder {
+public:
+    //! Checks out a reader handle; check the result with operator bool
+    DLLLOCAL ZipReaderHolder(ZipReaderPool& pool, ExceptionSink* xsink) : pool(pool), reader(pool.acquire(xsink)) {
+    }
+
+    DLLLOCAL ~ZipReaderHolder() {
+        if (reader) {
+            pool.release(reader);
+        }
+    }
+
+    DLLLOCAL operator bool() const {
+        return reader != nullptr;
+    }
+
+    //! Returns the mz_zip_reader handle
+    DLLLOCAL void* get() const {
+        return reader;
+    }
+
+    //! Returns the mz_zip handle of the reader
+    DLLLOCAL void* getZipHandle() const {
+        return ZipReaderPool::getZipHandle(reader);
+    }
+
+    //! Releases ownership of the reader handle; the caller must return it to the pool
+    DLLLOCAL void* release() {
+        void* rv = reader;
+        reader = nullptr;
+        return rv;
+    }
+
+private:
+    ZipReaderPool& pool;
+    void* reader;
+};
+
+#endif // _QORE_ZIP_ZIPREADERPOOL_H
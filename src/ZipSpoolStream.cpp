@@ -0,0 +1,166 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipSpoolStream.cpp ZipSpoolStream class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipSpoolStream.h"
+#include "ZipParallelWriter.h"
+
+#include <cstring>
+#include <new>
+
+mz_stream_vtbl ZipSpoolStream::vtbl = {
+    ZipSpoolStream::open,
+    ZipSpoolStream::isOpen,
+    ZipSpoolStream::read,
+    ZipSpoolStream::write,
+    ZipSpoolStream::tell,
+    ZipSpoolStream::seek,
+    ZipSpoolStream::close,
+    ZipSpoolStream::getError,
+    nullptr,
+    ZipSpoolStream::destroy,
+    nullptr,
+    nullptr,
+};
+
+ZipSpoolStream::ZipSpoolStream() {
+    stream.vtbl = &vtbl;
+    stream.base = nullptr;
+}
+
+ZipSpoolStream::~ZipSpoolStream() {
+    if (file) {
+        fclose(file);
+    }
+}
+
+void* ZipSpoolStream::create() {
+    ZipSpoolStream* s = new (std::nothrow) ZipSpoolStream;
+    return s ? &s->stream : nullptr;
+}
+
+int ZipSpoolStream::spill() {
+    // The temporary file is deleted automatically when it is closed
+    file = tmpfile();
+    if (!file || (len && fwrite(&mem[0], 1, (size_t)len, file) != (size_t)len)) {
+        return -1;
+    }
+    std::vector<char>().swap(mem);
+    return 0;
+}
+
+int32_t ZipSpoolStream::open(void* stream, const char* path, int32_t mode) {
+    // the stream is created open
+    return MZ_OK;
+}
+
+int32_t ZipSpoolStream::isOpen(void* stream) {
+    return MZ_OK;
+}
+
+int32_t ZipSpoolStream::read(void* stream, void* dest, int32_t len) {
+    ZipSpoolStream* s = static_cast<ZipSpoolStream*>(stream);
+    if (len <= 0 || s->pos >= s->len) {
+        return 0;
+    }
+
+    int32_t n = (s->len - s->pos < len) ? (int32_t)(s->len - s->pos) : len;
+    if (!s->file) {
+        memcpy(dest, &s->mem[s->pos], n);
+    } else if (fseeko(s->file, s->pos, SEEK_SET) || fread(dest, 1, n, s->file) != (size_t)n) {
+        s->error = MZ_READ_ERROR;
+        return MZ_READ_ERROR;
+    }
+    s->pos += n;
+    return n;
+}
+
+int32_t ZipSpoolStream::write(void* stream, const void* src, int32_t len) {
+    ZipSpoolStream* s = static_cast<ZipSpoolStream*>(stream);
+    if (len <= 0) {
+        return 0;
+    }
+
+    if (!s->file && s->pos + len > ZIP_WRITE_SPOOL_THRESHOLD && s->spill()) {
+        s->error = MZ_WRITE_ERROR;
+        return MZ_WRITE_ERROR;
+    }
+
+    if (s->file) {
+        if (fseeko(s->file, s->pos, SEEK_SET) || fwrite(src, 1, len, s->file) != (size_t)len) {
+            s->error = MZ_WRITE_ERROR;
+            return MZ_WRITE_ERROR;
+        }
+    } else {
+        if (s->pos + len > (int64)s->mem.size()) {
+            s->mem.resize(s->pos + len);
+        }
+        memcpy(&s->mem[s->pos], src, len);
+    }
+    s->pos += len;
+    if (s->pos > s->len) {
+        s->len = s->pos;
+    }
+    return len;
+}
+
+int64_t ZipSpoolStream::tell(void* stream) {
+    return static_cast<ZipSpoolStream*>(stream)->pos;
+}
+
+int32_t ZipSpoolStream::seek(void* stream, int64_t offset, int32_t origin) {
+    ZipSpoolStream* s = static_cast<ZipSpoolStream*>(stream);
+    int64 new_pos;
+    switch (origin) {
+        case MZ_SEEK_SET: new_pos = offset; break;
+        case MZ_SEEK_CUR: new_pos = s->pos + offset; break;
+        case MZ_SEEK_END: new_pos = s->len + offset; break;
+        default:
+            s->error = MZ_SEEK_ERROR;
+            return MZ_SEEK_ERROR;
+    }
+    if (new_pos < 0) {
+        s->error = MZ_SEEK_ERROR;
+        return MZ_SEEK_ERROR;
+    }
+    s->pos = new_pos;
+    return MZ_OK;
+}
+
+int32_t ZipSpoolStream::close(void* stream) {
+    // the data remains available until the stream is deleted
+    return MZ_OK;
+}
+
+int32_t ZipSpoolStream::getError(void* stream) {
+    return static_cast<ZipSpoolStream*>(stream)->error;
+}
+
+void ZipSpoolStream::destroy(void** stream) {
+    if (stream && *stream) {
+        delete static_cast<ZipSpoolStream*>(*stream);
+        *stream = nullptr;
+    }
+}
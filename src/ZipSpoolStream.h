@@ -0,0 +1,78 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipSpoolStream.h ZipSpoolStream class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPSPOOLSTREAM_H
+#define _QORE_ZIP_ZIPSPOOLSTREAM_H
+
+#include "zip-module.h"
+
+#include <cstdio>
+#include <vector>
+
+//! ZipSpoolStream - seekable read/write minizip stream for a temporary archive
+/** Data is kept in memory up to ZIP_WRITE_SPOOL_THRESHOLD bytes and in an anonymous temporary file beyond that.
+    Used for the private archive that a ZipOutputStream compresses and encrypts an entry into while it is written.
+
+    Streams are deleted with mz_stream_delete(), which also deletes the temporary file.
+*/
+class ZipSpoolStream {
+public:
+    //! Creates an empty open stream
+    /** @return a minizip stream or nullptr if no memory can be allocated
+    */
+    DLLLOCAL static void* create();
+
+private:
+    mz_stream stream;                   //!< must be the first member
+    std::vector<char> mem;              //!< the data until it is moved to the temporary file
+    FILE* file = nullptr;               //!< temporary file once the threshold has been exceeded
+    int64 pos = 0;                      //!< current stream position
+    int64 len = 0;                      //!< size of the data
+    int32_t error = MZ_OK;              //!< last error
+
+    static mz_stream_vtbl vtbl;
+
+    DLLLOCAL ZipSpoolStream();
+
+    DLLLOCAL ~ZipSpoolStream();
+
+    //! Moves the data to a temporary file
+    /** @return 0 on success, -1 if the temporary file cannot be created or written
+    */
+    DLLLOCAL int spill();
+
+    DLLLOCAL static int32_t open(void* stream, const char* path, int32_t mode);
+    DLLLOCAL static int32_t isOpen(void* stream);
+    DLLLOCAL static int32_t read(void* stream, void* dest, int32_t len);
+    DLLLOCAL static int32_t write(void* stream, const void* src, int32_t len);
+    DLLLOCAL static int64_t tell(void* stream);
+    DLLLOCAL static int32_t seek(void* stream, int64_t offset, int32_t origin);
+    DLLLOCAL static int32_t close(void* stream);
+    DLLLOCAL static int32_t getError(void* stream);
+    DLLLOCAL static void destroy(void** stream);
+};
+
+#endif // _QORE_ZIP_ZIPSPOOLSTREAM_H
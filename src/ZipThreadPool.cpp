@@ -0,0 +1,257 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipThreadPool.cpp ZipThreadPool class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipThreadPool.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <system_error>
+
+ZipThreadPool zip_thread_pool;
+
+ZipTaskGroup::ZipTaskGroup(unsigned max_threads, size_t max_queued, ZipThreadPool& pool)
+    : pool(pool), max_helpers(max_threads ? max_threads - 1 : 0), max_queued(max_queued ? max_queued : 1) {
+}
+
+ZipTaskGroup::~ZipTaskGroup() {
+    cancel();
+    wait();
+}
+
+void ZipTaskGroup::add(const task_t& task) {
+    std::unique_lock<std::mutex> lock(pool.m);
+    while (queue.size() >= max_queued) {
+        task_t t = pool.takeUnlocked(this);
+        lock.unlock();
+        t();
+        lock.lock();
+    }
+    pool.queueUnlocked(this, task);
+}
+
+void ZipTaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(pool.m);
+    while (true) {
+        if (!queue.empty()) {
+            task_t t = pool.takeUnlocked(this);
+            lock.unlock();
+            t();
+            lock.lock();
+            continue;
+        }
+        if (!helpers) {
+            break;
+        }
+        idle_cond.wait(lock);
+    }
+    // No pool thread may take the group after it has been destroyed
+    pool.unscheduleUnlocked(this);
+}
+
+bool ZipTaskGroup::runOne() {
+    std::unique_lock<std::mutex> lock(pool.m);
+    if (queue.empty()) {
+        return false;
+    }
+    task_t t = std::move(queue.front());
+    queue.pop_front();
+    --pool.stats.queued;
+    lock.unlock();
+    t();
+    return true;
+}
+
+void ZipTaskGroup::cancel() {
+    std::lock_guard<std::mutex> lock(pool.m);
+    pool.stats.queued -= queue.size();
+    queue.clear();
+}
+
+ZipThreadPool::ZipThreadPool() : jobs(UINT_MAX, SIZE_MAX, *this),
+        size(std::max(std::thread::hardware_concurrency(), 1u)) {
+}
+
+bool ZipThreadPool::submit(const task_t& task) {
+    std::lock_guard<std::mutex> lock(m);
+    queueUnlocked(&jobs, task);
+    if (!running) {
+        // No thread could be started to run the job
+        jobs.queue.pop_back();
+        --stats.queued;
+        return false;
+    }
+    return true;
+}
+
+void ZipThreadPool::setSize(unsigned new_size) {
+    std::lock_guard<std::mutex> lock(m);
+    size = new_size ? new_size : std::max(std::thread::hardware_concurrency(), 1u);
+    // Wake idle threads so that surplus threads exit
+    cond.notify_all();
+    // Start threads for groups waiting in the run queue
+    for (size_t i = run_queue.size(); i && running < size; --i) {
+        startThreadUnlocked();
+    }
+}
+
+unsigned ZipThreadPool::getSize() {
+    std::lock_guard<std::mutex> lock(m);
+    return size;
+}
+
+void ZipThreadPool::getStats(ZipThreadPoolStats& s) {
+    std::lock_guard<std::mutex> lock(m);
+    s = stats;
+    s.size = size;
+    s.threads = running;
+    s.busy = running - idle;
+}
+
+void ZipThreadPool::shutdown() {
+    std::list<Worker> threads;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+        threads.swap(workers);
+    }
+    cond.notify_all();
+    for (Worker& w : threads) {
+        w.thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m);
+    stopping = false;
+}
+
+void ZipThreadPool::queueUnlocked(ZipTaskGroup* group, const task_t& task) {
+    group->queue.push_back(task);
+    if (++stats.queued > stats.max_queued) {
+        stats.max_queued = stats.queued;
+    }
+    scheduleUnlocked(group);
+}
+
+ZipThreadPool::task_t ZipThreadPool::takeUnlocked(ZipTaskGroup* group) {
+    // The owner takes the newest task; pool threads steal the oldest
+    task_t task = std::move(group->queue.back());
+    group->queue.pop_back();
+    --stats.queued;
+    return task;
+}
+
+void ZipThreadPool::scheduleUnlocked(ZipTaskGroup* group) {
+    if (group->scheduled || group->queue.empty() || group->helpers >= group->max_helpers) {
+        return;
+    }
+    run_queue.push_back(group);
+    group->scheduled = true;
+    if (idle) {
+        cond.notify_one();
+    } else if (running < size && !stopping) {
+        startThreadUnlocked();
+    }
+}
+
+void ZipThreadPool::unscheduleUnlocked(ZipTaskGroup* group) {
+    if (group->scheduled) {
+        run_queue.erase(std::find(run_queue.begin(), run_queue.end(), group));
+        group->scheduled = false;
+    }
+}
+
+void ZipThreadPool::startThreadUnlocked() {
+    // Join threads that have exited after the pool size was reduced
+    for (std::list<Worker>::iterator i = workers.begin(); i != workers.end(); ) {
+        if (i->exited) {
+            i->thread.join();
+            i = workers.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    workers.emplace_back();
+    Worker* worker = &workers.back();
+    try {
+        worker->thread = std::thread(&ZipThreadPool::run, this, worker);
+    } catch (std::system_error&) {
+        // Queued tasks are run by the threads already started and by the owners of the groups
+        workers.pop_back();
+        return;
+    }
+    ++running;
+}
+
+void ZipThreadPool::run(Worker* worker) {
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+        while (!stopping && run_queue.empty() && running <= size) {
+            ++idle;
+            cond.wait(lock);
+            --idle;
+        }
+        if (running > size || run_queue.empty()) {
+            break;
+        }
+
+        // Take one task from the group at the head of the run queue and move the group to the tail, so that
+        // groups with queued tasks are served in turn
+        ZipTaskGroup* group = run_queue.front();
+        run_queue.pop_front();
+        group->scheduled = false;
+        if (group->queue.empty()) {
+            // The owner has run or discarded the remaining tasks
+            continue;
+        }
+        task_t task = std::move(group->queue.front());
+        group->queue.pop_front();
+        --stats.queued;
+        if (group != &jobs) {
+            ++stats.steals;
+        }
+        ++group->helpers;
+        scheduleUnlocked(group);
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        ++stats.tasks;
+        --group->helpers;
+        scheduleUnlocked(group);
+        if (!group->helpers) {
+            group->idle_cond.notify_all();
+        }
+    }
+
+    --running;
+    worker->exited = true;
+    if (!run_queue.empty()) {
+        // Hand queued tasks over to another thread
+        cond.notify_one();
+    }
+}
@@ -0,0 +1,186 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipThreadPool.h ZipThreadPool class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _QORE_ZIP_ZIPTHREADPOOL_H
+#define _QORE_ZIP_ZIPTHREADPOOL_H
+
+#include "zip-module.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+class ZipThreadPool;
+
+//! The module-wide thread pool
+DLLLOCAL extern ZipThreadPool zip_thread_pool;
+
+//! Counters and size of the module thread pool
+struct ZipThreadPoolStats {
+    int64 size = 0;             //!< the maximum number of pool threads
+    int64 threads = 0;          //!< the number of pool threads started
+    int64 busy = 0;             //!< the number of pool threads running a task
+    int64 queued = 0;           //!< the number of queued tasks
+    int64 max_queued = 0;       //!< the highest number of queued tasks
+    int64 tasks = 0;            //!< the number of tasks run by pool threads
+    int64 steals = 0;           //!< the number of tasks pool threads took from the queue of a parallel operation
+};
+
+//! ZipTaskGroup - the task queue of one parallel operation
+/** The thread that creates the group (the owner) adds tasks and runs queued tasks itself, newest first, when the
+    queue is full and in wait(); idle pool threads steal the oldest tasks from the queue.  Queue operations are
+    protected by the pool lock.
+
+    Tasks must not use the Qore API and must not throw exceptions.
+*/
+class ZipTaskGroup {
+public:
+    typedef std::function<void()> task_t;
+
+    //! Creates the group
+    /** @param max_threads the maximum number of threads running tasks of the group at the same time, including
+        the owner
+        @param max_queued the maximum number of queued tasks
+        @param pool the pool whose threads steal tasks from the group
+    */
+    DLLLOCAL ZipTaskGroup(unsigned max_threads, size_t max_queued, ZipThreadPool& pool = zip_thread_pool);
+
+    //! Discards queued tasks and waits for tasks running in pool threads
+    DLLLOCAL ~ZipTaskGroup();
+
+    //! Queues a task; if the queue is full, queued tasks are run in the calling thread first
+    DLLLOCAL void add(const task_t& task);
+
+    //! Runs queued tasks in the calling thread until none are left and waits for tasks running in pool threads
+    DLLLOCAL void wait();
+
+    //! Runs the oldest queued task in the calling thread
+    /** @return false if no task is queued
+    */
+    DLLLOCAL bool runOne();
+
+    //! Discards all queued tasks; may be called by a task
+    DLLLOCAL void cancel();
+
+private:
+    friend class ZipThreadPool;
+
+    ZipThreadPool& pool;
+    unsigned max_helpers;               //!< the maximum number of pool threads running tasks of the group
+    size_t max_queued;
+    std::deque<task_t> queue;
+    unsigned helpers = 0;               //!< the number of pool threads running tasks of the group
+    bool scheduled = false;             //!< true if the group is in the pool's run queue
+    std::condition_variable idle_cond;  //!< signaled when no pool thread is running tasks of the group
+
+    DLLLOCAL ZipTaskGroup(const ZipTaskGroup&) = delete;
+    DLLLOCAL ZipTaskGroup& operator=(const ZipTaskGroup&) = delete;
+};
+
+//! ZipThreadPool - module-wide pool of threads shared by all parallel and asynchronous archive operations
+/** Each parallel operation queues its tasks in its own ZipTaskGroup; groups with queued tasks are served
+    round-robin, one task at a time, so that an operation with many tasks cannot starve operations with few.
+    Asynchronous jobs are queued in a group of their own with submit().  Threads are started on demand up to the
+    pool size, which defaults to the number of CPU cores.  Tasks must not use the Qore API.
+
+    This class is thread-safe.
+*/
+class ZipThreadPool {
+public:
+    typedef ZipTaskGroup::task_t task_t;
+
+    DLLLOCAL ZipThreadPool();
+
+    //! Waits for all queued jobs and stops the threads
+    DLLLOCAL ~ZipThreadPool() {
+        shutdown();
+    }
+
+    //! Queues an independent job for execution by a pool thread
+    /** @return false if no thread could be started to run the job; the job is not queued in this case
+    */
+    DLLLOCAL bool submit(const task_t& task);
+
+    //! Sets the maximum number of pool threads; 0 sets it to the number of CPU cores
+    /** Surplus threads terminate when they have finished their current task
+    */
+    DLLLOCAL void setSize(unsigned size);
+
+    //! Returns the maximum number of pool threads
+    DLLLOCAL unsigned getSize();
+
+    //! Returns the size and counters of the pool
+    DLLLOCAL void getStats(ZipThreadPoolStats& stats);
+
+    //! Runs all queued jobs and stops the threads; the pool can be used again afterwards
+    DLLLOCAL void shutdown();
+
+private:
+    friend class ZipTaskGroup;
+
+    struct Worker {
+        std::thread thread;
+        bool exited = false;
+    };
+
+    std::mutex m;
+    std::condition_variable cond;       //!< signaled when a group is scheduled or the pool is shut down
+    std::deque<ZipTaskGroup*> run_queue;    //!< groups with tasks that another thread can run, in round-robin order
+    ZipTaskGroup jobs;                  //!< the group of independent jobs
+    std::list<Worker> workers;
+    unsigned size;
+    unsigned running = 0;               //!< the number of threads that have not exited
+    unsigned idle = 0;                  //!< the number of threads waiting for a task
+    bool stopping = false;
+    ZipThreadPoolStats stats;
+
+    DLLLOCAL ZipThreadPool(const ZipThreadPool&) = delete;
+    DLLLOCAL ZipThreadPool& operator=(const ZipThreadPool&) = delete;
+
+    //! Adds a task to the queue of the given group (must be called with the lock held)
+    DLLLOCAL void queueUnlocked(ZipTaskGroup* group, const task_t& task);
+
+    //! Takes the next task of the given group to be run by its owner (must be called with the lock held)
+    DLLLOCAL task_t takeUnlocked(ZipTaskGroup* group);
+
+    //! Adds the group to the run queue if a pool thread can run one of its tasks (must be called with the lock held)
+    DLLLOCAL void scheduleUnlocked(ZipTaskGroup* group);
+
+    //! Removes the group from the run queue (must be called with the lock held)
+    DLLLOCAL void unscheduleUnlocked(ZipTaskGroup* group);
+
+    //! Starts a thread and joins threads that have exited (must be called with the lock held)
+    DLLLOCAL void startThreadUnlocked();
+
+    //! Thread main loop
+    DLLLOCAL void run(Worker* worker);
+};
+
+#endif // _QORE_ZIP_ZIPTHREADPOOL_H
@@ -0,0 +1,172 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipTreeWalker.cpp ZipTreeWalker class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipTreeWalker.h"
+#include "ZipThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+ZipTreeWalker::ZipTreeWalker(const std::string& root, unsigned threads)
+    : root(root), threads(threads ? threads : 1) {
+    // Remove trailing slashes except for the file system root
+    while (this->root.size() > 1 && this->root.back() == '/') {
+        this->root.pop_back();
+    }
+}
+
+int ZipTreeWalker::walk(const check_t& check, std::vector<ZipTreeEntry>& entries, std::string& error) {
+    dirs.clear();
+    dirs.emplace_back();
+    dirs.back().path = root;
+
+    std::vector<Dir*> level = { &dirs.back() };
+    while (!level.empty()) {
+        // Directories are checked in the calling thread before they are listed
+        for (Dir* dir : level) {
+            if (check(dir->path)) {
+                return -1;
+            }
+        }
+
+        bool top = level.front() == &dirs.front();
+        if (threads == 1 || level.size() == 1) {
+            for (Dir* dir : level) {
+                list(*dir, top);
+            }
+        } else {
+            ZipTaskGroup group(std::min(threads, (unsigned)level.size()), threads * 2);
+            for (Dir* dir : level) {
+                group.add([dir, top] () {
+                    list(*dir, top);
+                });
+            }
+            group.wait();
+        }
+
+        // The subdirectories of all directories of this level form the next level
+        std::vector<Dir*> next;
+        for (Dir* dir : level) {
+            if (dir->err) {
+                error = "failed to read directory '" + dir->path + "': " + strerror(dir->err);
+                return -1;
+            }
+            for (Item& item : dir->items) {
+                if (item.is_dir) {
+                    dirs.emplace_back();
+                    Dir& sub = dirs.back();
+                    sub.path = join(dir->path, item.name);
+                    sub.name = dir->name + item.name + "/";
+                    item.dir = &sub;
+                    next.push_back(&sub);
+                }
+            }
+        }
+        level.swap(next);
+    }
+
+    flatten(dirs.front(), entries);
+    return 0;
+}
+
+void ZipTreeWalker::list(Dir& dir, bool root) {
+    DIR* d = opendir(dir.path.c_str());
+    if (!d) {
+        // Subdirectories that disappear while the tree is listed are skipped
+        if (root || errno != ENOENT) {
+            dir.err = errno;
+        }
+        return;
+    }
+
+    int fd = dirfd(d);
+    while (true) {
+        errno = 0;
+        struct dirent* de = readdir(d);
+        if (!de) {
+            dir.err = errno;
+            break;
+        }
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+
+        bool is_dir;
+        switch (de->d_type) {
+            case DT_DIR:
+                is_dir = true;
+                break;
+            case DT_REG:
+                is_dir = false;
+                break;
+            case DT_UNKNOWN: {
+                // Not all file systems return the file type
+                struct stat st;
+                if (fstatat(fd, de->d_name, &st, AT_SYMLINK_NOFOLLOW)) {
+                    continue;
+                }
+                if (S_ISDIR(st.st_mode)) {
+                    is_dir = true;
+                } else if (S_ISREG(st.st_mode)) {
+                    is_dir = false;
+                } else {
+                    continue;
+                }
+                break;
+            }
+            default:
+                continue;
+        }
+
+        dir.items.emplace_back();
+        dir.items.back().name = de->d_name;
+        dir.items.back().is_dir = is_dir;
+    }
+    closedir(d);
+
+    std::sort(dir.items.begin(), dir.items.end());
+}
+
+void ZipTreeWalker::flatten(const Dir& dir, std::vector<ZipTreeEntry>& entries) {
+    for (const Item& item : dir.items) {
+        entries.emplace_back();
+        ZipTreeEntry& entry = entries.back();
+        if (item.dir) {
+            entry.path = item.dir->path;
+            entry.name = item.dir->name;
+            entry.is_dir = true;
+            flatten(*item.dir, entries);
+        } else {
+            entry.path = join(dir.path, item.name);
+            entry.name = dir.name + item.name;
+        }
+    }
+}
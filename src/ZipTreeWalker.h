@@ -0,0 +1,107 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipTreeWalker.h ZipTreeWalker class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPTREEWALKER_H
+#define _QORE_ZIP_ZIPTREEWALKER_H
+
+#include "zip-module.h"
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+//! A file or directory found by a ZipTreeWalker
+struct ZipTreeEntry {
+    std::string path;                   //!< the path of the file or directory
+    std::string name;                   //!< the path relative to the root; directories end with '/'
+    bool is_dir = false;
+};
+
+//! ZipTreeWalker - lists a directory tree with the module thread pool
+/** The tree is listed level by level: the directories of each level are listed in parallel by the calling thread
+    and the pool threads of a ZipTaskGroup.  Regular files and directories are returned in a deterministic order
+    (depth-first, sorted by name); symbolic links and special files are skipped.
+
+    Listing directories does not use the Qore API; the callback checking directories before they are listed is
+    called in the calling thread.
+*/
+class ZipTreeWalker {
+public:
+    //! Checks a directory before it is listed; returns 0 to list it or -1 to stop the walk
+    typedef std::function<int(const std::string&)> check_t;
+
+    //! Creates the walker for the given root directory and number of threads including the calling thread
+    DLLLOCAL ZipTreeWalker(const std::string& root, unsigned threads);
+
+    //! Lists the tree
+    /** @param check called for each directory before it is listed, starting with the root directory
+        @param entries the files and directories found, without the root directory
+        @param error the error message if a directory cannot be listed
+
+        @return 0 on success, -1 if \a check returned -1 or a directory could not be listed (\a error is set)
+    */
+    DLLLOCAL int walk(const check_t& check, std::vector<ZipTreeEntry>& entries, std::string& error);
+
+private:
+    struct Dir;
+
+    //! An entry of a directory
+    struct Item {
+        std::string name;
+        bool is_dir = false;
+        Dir* dir = nullptr;             //!< the subdirectory once it has been added to the tree
+
+        DLLLOCAL bool operator<(const Item& other) const {
+            return name < other.name;
+        }
+    };
+
+    //! A directory of the tree
+    struct Dir {
+        std::string path;
+        std::string name;               //!< the path relative to the root with a trailing '/'; empty for the root
+        std::vector<Item> items;        //!< the entries sorted by name
+        int err = 0;                    //!< the errno value if the directory cannot be listed
+    };
+
+    std::string root;
+    unsigned threads;
+    std::deque<Dir> dirs;               //!< all directories found; pointers to them stay valid
+
+    //! Lists a directory; does not use the Qore API
+    DLLLOCAL static void list(Dir& dir, bool root);
+
+    //! Returns the path of an entry of the given directory
+    DLLLOCAL static std::string join(const std::string& dir, const std::string& name) {
+        return dir == "/" ? dir + name : dir + "/" + name;
+    }
+
+    //! Appends the entries of a directory and its subdirectories depth-first
+    DLLLOCAL static void flatten(const Dir& dir, std::vector<ZipTreeEntry>& entries);
+};
+
+#endif // _QORE_ZIP_ZIPTREEWALKER_H
@@ -0,0 +1,136 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipVerifier.cpp ZipVerifier class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipVerifier.h"
+#include "ZipThreadPool.h"
+
+#include <mz_crypt.h>
+
+#include <algorithm>
+
+ZipVerifier::ZipVerifier(ZipReaderPool& readers, const ZipEntryIndex& index, const char* password)
+    : readers(readers), index(index), password(password ? password : ""), has_password(password != nullptr),
+      results(index.getEntryCount()), open_error(MZ_OK) {
+}
+
+void ZipVerifier::run(unsigned threads) {
+    size_t count = index.getEntryCount();
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            verifyEntry(i);
+        }
+        return;
+    }
+
+    // Largest entries first, so that no single large entry is left for the end
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        order.push_back((uint32_t)i);
+    }
+    const ZipEntryIndex& ix = index;
+    std::stable_sort(order.begin(), order.end(), [&ix] (uint32_t a, uint32_t b) {
+        return ix.getSize(a) > ix.getSize(b);
+    });
+
+    ZipTaskGroup group(threads, threads * 2);
+    for (uint32_t i : order) {
+        group.add([this, i] () {
+            verifyEntry(i);
+        });
+    }
+    group.wait();
+}
+
+void ZipVerifier::verifyEntry(size_t i) {
+    int32_t err = MZ_OK;
+    void* reader = readers.acquire(err);
+    if (!reader) {
+        open_error.store(err);
+        return;
+    }
+
+    // Each thread decompresses into its own scratch buffer
+    static thread_local std::vector<char> buf;
+    if (buf.empty()) {
+        buf.resize(ZIP_VERIFY_BUF_SIZE);
+    }
+    verify(ZipReaderPool::getZipHandle(reader), index, i, has_password ? password.c_str() : nullptr, &buf[0],
+           (int32_t)buf.size(), results[i]);
+    readers.release(reader);
+}
+
+void ZipVerifier::verify(void* zip_handle, const ZipEntryIndex& index, size_t i, const char* entry_password,
+                         char* buf, int32_t buf_size, ZipVerifyResult& result) {
+    if (index.isDirectory(i)) {
+        result.status = ZipVerifyResult::OK;
+        return;
+    }
+
+    int32_t err = mz_zip_goto_entry(zip_handle, index.getCdPos(i));
+    if (err == MZ_OK) {
+        err = mz_zip_entry_read_open(zip_handle, 0, entry_password);
+    }
+    if (err != MZ_OK) {
+        result.status = ZipVerifyResult::OPEN_ERROR;
+        result.error_code = err;
+        return;
+    }
+
+    uint32_t crc = 0;
+    int64 size = 0;
+    while (true) {
+        int32_t bytes_read = mz_zip_entry_read(zip_handle, buf, buf_size);
+        if (bytes_read <= 0) {
+            err = bytes_read;
+            break;
+        }
+        crc = mz_crypt_crc32_update(crc, (const uint8_t*)buf, bytes_read);
+        size += bytes_read;
+    }
+    int32_t close_err = mz_zip_entry_close(zip_handle);
+    if (err == MZ_OK) {
+        err = close_err;
+    }
+
+    result.size = size;
+    result.crc = crc;
+
+    // AE-2 encrypted entries store a CRC-32 of 0 and are authenticated by their HMAC instead
+    bool check_crc = !(index.isEncrypted(i) && !index.getCrc(i));
+    if (err == MZ_CRC_ERROR) {
+        result.status = ZipVerifyResult::CRC_MISMATCH;
+    } else if (err != MZ_OK) {
+        result.status = ZipVerifyResult::READ_ERROR;
+        result.error_code = err;
+    } else if (size != index.getSize(i)) {
+        result.status = ZipVerifyResult::SIZE_MISMATCH;
+    } else if (check_crc && crc != index.getCrc(i)) {
+        result.status = ZipVerifyResult::CRC_MISMATCH;
+    } else {
+        result.status = ZipVerifyResult::OK;
+    }
+}
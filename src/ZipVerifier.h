@@ -0,0 +1,114 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipVerifier.h ZipVerifier class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef _QORE_ZIP_ZIPVERIFIER_H
+#define _QORE_ZIP_ZIPVERIFIER_H
+
+#include "zip-module.h"
+#include "ZipEntryIndex.h"
+#include "ZipReaderPool.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+//! Size of the scratch buffer each verification thread decompresses entries into (256KB)
+#define ZIP_VERIFY_BUF_SIZE (256 * 1024)
+
+//! Verification result of a single entry
+struct ZipVerifyResult {
+    //! Verification status
+    enum Status : uint8_t {
+        NOT_CHECKED,        //!< the entry has not been verified
+        OK,                 //!< the data matches the CRC-32 and size in the central directory
+        OPEN_ERROR,         //!< the entry could not be opened
+        READ_ERROR,         //!< the entry data could not be read or decompressed
+        CRC_MISMATCH,       //!< the CRC-32 of the data does not match the central directory
+        SIZE_MISMATCH,      //!< the size of the data does not match the central directory
+    };
+
+    Status status = NOT_CHECKED;
+    int32_t error_code = MZ_OK;     //!< the minizip error code for OPEN_ERROR and READ_ERROR
+    int64 size = 0;                 //!< the number of bytes decompressed
+    uint32_t crc = 0;               //!< the CRC-32 of the decompressed data
+};
+
+//! ZipVerifier - verifies the data of all entries of an archive with the module thread pool
+/** Each entry is queued largest first as a task of a ZipTaskGroup; the calling thread and the pool threads
+    running the tasks check out a reader handle from the archive's ZipReaderPool for each entry and decompress
+    it into a per-thread scratch buffer, so memory use does not depend on the size of the entries.  Tasks do not
+    use the Qore API; results are stored per entry and evaluated by the calling thread.
+
+    The archive must stay open (its read lock held) until run() has returned.
+*/
+class ZipVerifier {
+public:
+    //! Creates the verifier
+    /** @param readers the reader pool of the archive
+        @param index the entry index of the archive
+        @param password the password for encrypted entries, or nullptr
+    */
+    DLLLOCAL ZipVerifier(ZipReaderPool& readers, const ZipEntryIndex& index, const char* password);
+
+    //! Verifies all entries with the calling thread and up to \a threads - 1 pool threads
+    /** Entries that could not be verified because no reader could be opened remain NOT_CHECKED; see
+        getOpenError()
+    */
+    DLLLOCAL void run(unsigned threads);
+
+    //! Returns the result for the entry with the given index position
+    DLLLOCAL const ZipVerifyResult& getResult(size_t i) const {
+        return results[i];
+    }
+
+    //! Returns the error code of the last failure to open a reader, or MZ_OK
+    DLLLOCAL int32_t getOpenError() const {
+        return open_error.load();
+    }
+
+    //! Verifies one entry with the given mz_zip handle and scratch buffer
+    DLLLOCAL static void verify(void* zip_handle, const ZipEntryIndex& index, size_t i, const char* entry_password,
+                                char* buf, int32_t buf_size, ZipVerifyResult& result);
+
+private:
+    ZipReaderPool& readers;
+    const ZipEntryIndex& index;
+    std::string password;
+    bool has_password;
+
+    //! Results by entry index position; each element is only written by the thread verifying the entry
+    std::vector<ZipVerifyResult> results;
+    std::atomic<int32_t> open_error;
+
+    DLLLOCAL ZipVerifier(const ZipVerifier&) = delete;
+    DLLLOCAL ZipVerifier& operator=(const ZipVerifier&) = delete;
+
+    //! Verifies the entry at the given index position with a reader from the pool
+    DLLLOCAL void verifyEntry(size_t i);
+};
+
+#endif // _QORE_ZIP_ZIPVERIFIER_H
@@ -0,0 +1,125 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipWritePipeline.cpp ZipWritePipeline class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipWritePipeline.h"
+#include "ZipThreadPool.h"
+
+#include <algorithm>
+
+ZipWritePipeline::ZipWritePipeline(size_t buffers, const consumer_t& consumer)
+    : consumer(consumer), max_buffers(std::max(buffers, (size_t)1)) {
+    current.reserve(ZIP_PIPELINE_BUF_SIZE);
+}
+
+ZipWritePipeline::~ZipWritePipeline() {
+    // The consumer may not run after the pipeline has been deleted
+    std::unique_lock<std::mutex> guard(lock);
+    while (running) {
+        cond.wait(guard);
+    }
+}
+
+int32_t ZipWritePipeline::write(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len) {
+        size_t n = std::min(len, ZIP_PIPELINE_BUF_SIZE - current.size());
+        current.insert(current.end(), p, p + n);
+        p += n;
+        len -= n;
+        if (current.size() == ZIP_PIPELINE_BUF_SIZE) {
+            int32_t rc = push();
+            if (rc != MZ_OK) {
+                return rc;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    return err;
+}
+
+int32_t ZipWritePipeline::finish() {
+    if (!current.empty()) {
+        push();
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (running) {
+        cond.wait(guard);
+    }
+    return err;
+}
+
+int32_t ZipWritePipeline::push() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (queue.size() >= max_buffers && err == MZ_OK) {
+        cond.wait(guard);
+    }
+    if (err != MZ_OK) {
+        current.clear();
+        return err;
+    }
+
+    queue.push_back(std::move(current));
+    if (free_buffers.empty()) {
+        current = std::vector<char>();
+        current.reserve(ZIP_PIPELINE_BUF_SIZE);
+    } else {
+        current = std::move(free_buffers.back());
+        free_buffers.pop_back();
+        current.clear();
+    }
+
+    if (!running) {
+        running = true;
+        guard.unlock();
+        if (!zip_thread_pool.submit([this] () { run(); })) {
+            run();
+        }
+    }
+    return MZ_OK;
+}
+
+void ZipWritePipeline::run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!queue.empty()) {
+        // Buffers are only added at the back of the queue, so the reference stays valid without the lock
+        std::vector<char>& buf = queue.front();
+        if (err == MZ_OK) {
+            guard.unlock();
+            int32_t rc = consumer(&buf[0], buf.size());
+            guard.lock();
+            if (rc != MZ_OK) {
+                err = rc;
+            }
+        }
+        free_buffers.push_back(std::move(buf));
+        queue.pop_front();
+        cond.notify_all();
+    }
+    running = false;
+    cond.notify_all();
+}
@@ -0,0 +1,96 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipWritePipeline.h ZipWritePipeline class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPWRITEPIPELINE_H
+#define _QORE_ZIP_ZIPWRITEPIPELINE_H
+
+#include "zip-module.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//! Size of the buffers of a ZipWritePipeline (256KB)
+#define ZIP_PIPELINE_BUF_SIZE (256 * 1024)
+
+//! ZipWritePipeline - passes data written by one thread to a consumer running in the module thread pool
+/** Data is copied into buffers of ZIP_PIPELINE_BUF_SIZE bytes; full buffers are queued for the consumer, which is
+    run as a job in the module thread pool while buffers are queued, so the writing thread can produce the next
+    data while the previous data is compressed and written.  When the given number of buffers is queued, write()
+    blocks until the consumer has processed a buffer.  If no pool thread can be started, the consumer runs in the
+    writing thread.
+
+    The consumer must not use the Qore API.  All methods must be called in the same thread.
+*/
+class ZipWritePipeline {
+public:
+    //! Processes a buffer; returns MZ_OK on success, otherwise a minizip error code
+    typedef std::function<int32_t(const char*, size_t)> consumer_t;
+
+    //! Creates the pipeline
+    /** @param buffers the maximum number of full buffers queued for the consumer (at least 1)
+        @param consumer called in a pool thread for each buffer in order
+    */
+    DLLLOCAL ZipWritePipeline(size_t buffers, const consumer_t& consumer);
+
+    //! Waits for the consumer to process all queued buffers
+    DLLLOCAL ~ZipWritePipeline();
+
+    //! Copies data into the pipeline, waiting for the consumer if all buffers are queued
+    /** @return MZ_OK on success, otherwise the first error returned by the consumer; once the consumer has failed,
+        the following data is discarded
+    */
+    DLLLOCAL int32_t write(const void* data, size_t len);
+
+    //! Queues the remaining data and waits until the consumer has processed all buffers
+    /** @return MZ_OK on success, otherwise the first error returned by the consumer
+    */
+    DLLLOCAL int32_t finish();
+
+private:
+    consumer_t consumer;
+    size_t max_buffers;
+    std::mutex lock;
+    std::condition_variable cond;       //!< signaled when a buffer has been processed and when the consumer exits
+    std::deque<std::vector<char>> queue;    //!< full buffers; the consumer removes the first one when processed
+    std::vector<std::vector<char>> free_buffers;    //!< processed buffers for reuse
+    std::vector<char> current;          //!< the buffer being filled by the writing thread
+    int32_t err = MZ_OK;
+    bool running = false;               //!< true if the consumer job has been submitted and has not exited
+
+    DLLLOCAL ZipWritePipeline(const ZipWritePipeline&) = delete;
+    DLLLOCAL ZipWritePipeline& operator=(const ZipWritePipeline&) = delete;
+
+    //! Queues the current buffer and starts the consumer if necessary
+    DLLLOCAL int32_t push();
+
+    //! Processes queued buffers until the queue is empty
+    DLLLOCAL void run();
+};
+
+#endif // _QORE_ZIP_ZIPWRITEPIPELINE_H
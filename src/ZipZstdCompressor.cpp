@@ -0,0 +1,109 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipZstdCompressor.cpp ZipZstdCompressor class implementation */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ZipZstdCompressor.h"
+
+#ifdef HAVE_ZSTD
+#include <mz_crypt.h>
+
+#include <algorithm>
+
+ZipZstdCompressor::ZipZstdCompressor(int level, unsigned threads, bool long_window, const sink_t& sink)
+    : ZipEntryCompressor(sink), cctx(ZSTD_createCCtx()), out_buf(ZSTD_CStreamOutSize()) {
+    if (!cctx) {
+        err = MZ_MEM_ERROR;
+        return;
+    }
+
+    size_t rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                                       level == MZ_COMPRESS_LEVEL_DEFAULT ? ZSTD_CLEVEL_DEFAULT : level);
+    // Fails if libzstd was built without multithreading support
+    if (!ZSTD_isError(rc) && threads) {
+        rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, (int)threads);
+    }
+    if (!ZSTD_isError(rc) && long_window) {
+        rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+        if (!ZSTD_isError(rc)) {
+            rc = ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, ZIP_ZSTD_LONG_WINDOW_LOG);
+        }
+    }
+    if (ZSTD_isError(rc)) {
+        err = MZ_PARAM_ERROR;
+    }
+}
+
+ZipZstdCompressor::~ZipZstdCompressor() {
+    ZSTD_freeCCtx(cctx);
+}
+
+int32_t ZipZstdCompressor::write(const void* data, size_t len) {
+    if (finished) {
+        return err == MZ_OK ? MZ_PARAM_ERROR : err;
+    }
+    if (err != MZ_OK || !len) {
+        return err;
+    }
+
+    const char* p = (const char*)data;
+    for (size_t done = 0; done < len; ) {
+        int32_t n = (int32_t)std::min(len - done, (size_t)(1 << 30));
+        crc = mz_crypt_crc32_update(crc, (const uint8_t*)p + done, n);
+        done += n;
+    }
+    size += len;
+
+    ZSTD_inBuffer in = { data, len, 0 };
+    return compress(in, ZSTD_e_continue);
+}
+
+int32_t ZipZstdCompressor::finish() {
+    if (!finished) {
+        finished = true;
+        if (err == MZ_OK) {
+            ZSTD_inBuffer in = { nullptr, 0, 0 };
+            compress(in, ZSTD_e_end);
+        }
+    }
+    return err;
+}
+
+int32_t ZipZstdCompressor::compress(ZSTD_inBuffer& in, ZSTD_EndDirective mode) {
+    while (true) {
+        ZSTD_outBuffer out = { &out_buf[0], out_buf.size(), 0 };
+        size_t rc = ZSTD_compressStream2(cctx, &out, &in, mode);
+        if (ZSTD_isError(rc)) {
+            return err = MZ_DATA_ERROR;
+        }
+        if (output(&out_buf[0], out.pos)) {
+            return err;
+        }
+        // With ZSTD_e_end, rc is the amount of data left to flush
+        if (mode == ZSTD_e_end ? !rc : in.pos == in.size) {
+            return MZ_OK;
+        }
+    }
+}
+#endif
@@ -0,0 +1,72 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/** @file ZipZstdCompressor.h ZipZstdCompressor class header */
+/*
+    Qore zip module
+
+    Copyright (C) 2026 Qore Technologies, s.r.o.
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _QORE_ZIP_ZIPZSTDCOMPRESSOR_H
+#define _QORE_ZIP_ZIPZSTDCOMPRESSOR_H
+
+#include "zip-module.h"
+#include "ZipEntryCompressor.h"
+
+#ifdef HAVE_ZSTD
+#include <vector>
+
+#include <zstd.h>
+
+//! Window size used with long distance matching; 128MB is the largest window zstd decoders accept by default
+#define ZIP_ZSTD_LONG_WINDOW_LOG 27
+
+//! ZipZstdCompressor - compresses the data of one entry into a single zstd frame with libzstd
+/** Unlike minizip's zstd stream, this compressor can use zstd's own worker threads (\c ZSTD_c_nbWorkers) and long
+    distance matching.  With one or more worker threads, the compressed data is the same for any number of threads.
+
+    Does not use the Qore API; all methods must be called in the same thread.
+*/
+class ZipZstdCompressor : public ZipEntryCompressor {
+public:
+    //! Creates the compressor
+    /** @param level the zstd compression level; \c MZ_COMPRESS_LEVEL_DEFAULT for zstd's default level
+        @param threads the number of zstd worker threads; 0 to compress the data in the calling thread
+        @param long_window true to enable long distance matching with a window of 2^ZIP_ZSTD_LONG_WINDOW_LOG bytes
+        @param sink called with the compressed data in order
+    */
+    DLLLOCAL ZipZstdCompressor(int level, unsigned threads, bool long_window, const sink_t& sink);
+
+    DLLLOCAL virtual ~ZipZstdCompressor();
+
+    DLLLOCAL virtual int32_t write(const void* data, size_t len) override;
+
+    DLLLOCAL virtual int32_t finish() override;
+
+private:
+    ZSTD_CCtx* cctx;
+    std::vector<char> out_buf;
+
+    //! Compresses the given input with the given directive until it has been consumed or the frame has ended
+    DLLLOCAL int32_t compress(ZSTD_inBuffer& in, ZSTD_EndDirective mode);
+};
+#endif
+
+#endif // _QORE_ZIP_ZIPZSTDCOMPRESSOR_H
@@ -28,13 +28,15 @@
 #include "QC_ZipFile.h"
 #include "QC_ZipInputStream.h"
 #include "QC_ZipOutputStream.h"
+#include "ZipIndexCache.h"
+#include "ZipThreadPool.h"
 
 static QoreStringNode* zip_module_init();
 static void zip_module_ns_init(QoreNamespace* rns, QoreNamespace* qns);
 static void zip_module_delete();
 
 DLLEXPORT char qore_module_name[] = "zip";
-DLLEXPORT char qore_module_version[] = "1.0.0";
+DLLEXPORT char qore_module_version[] = "1.1.0";
 DLLEXPORT char qore_module_description[] = "Qore ZIP archive module";
 DLLEXPORT char qore_module_author[] = "Qore Technologies, s.r.o.";
 DLLEXPORT char qore_module_url[] = "https://github.com/qoretechnologies/module-zip";
@@ -49,7 +51,17 @@ DLLEXPORT char qore_module_license_str[] = "MIT";
 // Global hashdecl pointers
 const TypedHashDecl* hashdeclZipEntryInfo = nullptr;
 const TypedHashDecl* hashdeclZipAddOptions = nullptr;
+const TypedHashDecl* hashdeclZipBatchAddOptions = nullptr;
+const TypedHashDecl* hashdeclZipAddFileSpec = nullptr;
 const TypedHashDecl* hashdeclZipExtractOptions = nullptr;
+const TypedHashDecl* hashdeclZipArchiveSummary = nullptr;
+const TypedHashDecl* hashdeclZipEntryColumns = nullptr;
+const TypedHashDecl* hashdeclZipOpenOptions = nullptr;
+const TypedHashDecl* hashdeclZipIndexCacheInfo = nullptr;
+const TypedHashDecl* hashdeclZipVerifyOptions = nullptr;
+const TypedHashDecl* hashdeclZipEntryVerifyResult = nullptr;
+const TypedHashDecl* hashdeclZipVerifyReport = nullptr;
+const TypedHashDecl* hashdeclZipThreadPoolInfo = nullptr;
 
 QoreNamespace ZipNs("Qore::Zip");
 
@@ -57,14 +69,26 @@ static QoreStringNode* zip_module_init() {
     // Initialize hashdecls (defined in QPP files for documentation)
     hashdeclZipEntryInfo = init_hashdecl_ZipEntryInfo(ZipNs);
     hashdeclZipAddOptions = init_hashdecl_ZipAddOptions(ZipNs);
+    hashdeclZipBatchAddOptions = init_hashdecl_ZipBatchAddOptions(ZipNs);
+    hashdeclZipAddFileSpec = init_hashdecl_ZipAddFileSpec(ZipNs);
     hashdeclZipExtractOptions = init_hashdecl_ZipExtractOptions(ZipNs);
+    hashdeclZipArchiveSummary = init_hashdecl_ZipArchiveSummary(ZipNs);
+    hashdeclZipEntryColumns = init_hashdecl_ZipEntryColumns(ZipNs);
+    hashdeclZipOpenOptions = init_hashdecl_ZipOpenOptions(ZipNs);
+    hashdeclZipIndexCacheInfo = init_hashdecl_ZipIndexCacheInfo(ZipNs);
+    hashdeclZipVerifyOptions = init_hashdecl_ZipVerifyOptions(ZipNs);
+    hashdeclZipEntryVerifyResult = init_hashdecl_ZipEntryVerifyResult(ZipNs);
+    hashdeclZipVerifyReport = init_hashdecl_ZipVerifyReport(ZipNs);
+    hashdeclZipThreadPoolInfo = init_hashdecl_ZipThreadPoolInfo(ZipNs);
 
-    // Initialize classes - stream classes must be initialized before ZipFile
+    // Initialize classes - stream, entry, iterator and job classes must be initialized before ZipFile
     // because ZipFile references them as return types
     ZipNs.addSystemClass(initZipInputStreamClass(ZipNs));
     ZipNs.addSystemClass(initZipOutputStreamClass(ZipNs));
-    ZipNs.addSystemClass(initZipFileClass(ZipNs));
     ZipNs.addSystemClass(initZipEntryClass(ZipNs));
+    ZipNs.addSystemClass(initZipEntryIteratorClass(ZipNs));
+    ZipNs.addSystemClass(initZipJobClass(ZipNs));
+    ZipNs.addSystemClass(initZipFileClass(ZipNs));
 
     return nullptr;
 }
@@ -74,5 +98,8 @@ static void zip_module_ns_init(QoreNamespace* rns, QoreNamespace* qns) {
 }
 
 static void zip_module_delete() {
-    // Cleanup if needed
+    // Release cached indexes while the module is still loaded
+    zip_index_cache.clear();
+    // Stop the background threads before the module is unloaded
+    zip_thread_pool.shutdown();
 }
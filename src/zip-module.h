@@ -42,7 +42,17 @@ class QoreZipFile;
 // Hashdecl init functions (generated by QPP from QC_ZipFile.qpp)
 DLLLOCAL TypedHashDecl* init_hashdecl_ZipEntryInfo(QoreNamespace& ns);
 DLLLOCAL TypedHashDecl* init_hashdecl_ZipAddOptions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipBatchAddOptions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipAddFileSpec(QoreNamespace& ns);
 DLLLOCAL TypedHashDecl* init_hashdecl_ZipExtractOptions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipArchiveSummary(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipEntryColumns(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipOpenOptions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipIndexCacheInfo(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipVerifyOptions(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipEntryVerifyResult(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipVerifyReport(QoreNamespace& ns);
+DLLLOCAL TypedHashDecl* init_hashdecl_ZipThreadPoolInfo(QoreNamespace& ns);
 
 // Compression methods
 #define ZIP_CM_STORE        MZ_COMPRESS_METHOD_STORE
@@ -68,7 +78,17 @@ DLLLOCAL TypedHashDecl* init_hashdecl_ZipExtractOptions(QoreNamespace& ns);
 // Global hashdecl pointers (initialized in zip-module.cpp)
 extern const TypedHashDecl* hashdeclZipEntryInfo;
 extern const TypedHashDecl* hashdeclZipAddOptions;
+extern const TypedHashDecl* hashdeclZipBatchAddOptions;
+extern const TypedHashDecl* hashdeclZipAddFileSpec;
 extern const TypedHashDecl* hashdeclZipExtractOptions;
+extern const TypedHashDecl* hashdeclZipArchiveSummary;
+extern const TypedHashDecl* hashdeclZipEntryColumns;
+extern const TypedHashDecl* hashdeclZipOpenOptions;
+extern const TypedHashDecl* hashdeclZipIndexCacheInfo;
+extern const TypedHashDecl* hashdeclZipVerifyOptions;
+extern const TypedHashDecl* hashdeclZipEntryVerifyResult;
+extern const TypedHashDecl* hashdeclZipVerifyReport;
+extern const TypedHashDecl* hashdeclZipThreadPoolInfo;
 
 // Namespace
 extern QoreNamespace ZipNs;